@@ -6,6 +6,7 @@
 #include "../interpreter/interpreter.hpp"
 #include "../lexer/lexer.hpp"
 #include "../parser/parser.hpp"
+#include "../parser/resolver.hpp"
 #include "../system/pipeline.hpp"
 
 #include <cassert>
@@ -26,7 +27,8 @@ Driver::Driver(Setup setup) : setup(setup) {}
  */
 Setup Driver::default_setup() {
   return Setup{std::nullopt, InputMethod::ConfigFile, "./qvickbuild",
-               LogLevel::Standard, false};
+               LogLevel::Standard, false, false, false, 4ull << 30, false,
+               false};
 }
 
 /*!
@@ -61,7 +63,7 @@ std::vector<unsigned char> Driver::get_config() {
  * configuration source passed.
  * \param config the configuration source to refer to.
  */
-void Driver::unwind_errors(std::vector<unsigned char> config) {
+void Driver::unwind_errors(std::span<unsigned char const> config) {
   bool verbose_threads = ErrorHandler::get_errors().size() > 1;
   std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>> frames =
       ContextStack::dump_stack();
@@ -119,6 +121,8 @@ int Driver::run() {
 
     Parser parser = Parser(token_stream);
     AST ast(parser.parse_tokens());
+    Resolver resolver(ast);
+    resolver.resolve();
 
     // build task.
     Interpreter interpreter(ast, this->setup);
@@ -2,8 +2,10 @@
 #define DRIVER_H
 
 #include "../cli/cli.hpp"
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -24,6 +26,11 @@ struct Setup {
   std::string input_file; // only used for InputMethod::ConfigFile.
   LogLevel logging_level;
   bool dry_run;
+  bool content_hash; // decide staleness from file contents.
+  bool action_cache; // reuse outputs from the shared action cache.
+  uint64_t action_cache_size; // in bytes.
+  bool eager_globals; // evaluate globs ahead of the build, in parallel.
+  bool pipelined; // run jobs while the task graph is still being evaluated.
 };
 
 /*!
@@ -33,7 +40,7 @@ class Driver {
 private:
   Setup setup;
 
-  void unwind_errors(std::vector<unsigned char> config);
+  void unwind_errors(std::span<unsigned char const> config);
   std::vector<unsigned char> get_config();
 
 public:
@@ -38,6 +38,25 @@ int main(int argc, char **argv) {
       setup.logging_level = LogLevel::Verbose;
     } else if (*arg_it == "--dry-run") {
       setup.dry_run = true;
+    } else if (*arg_it == "--content-hash") {
+      setup.content_hash = true;
+    } else if (*arg_it == "--action-cache") {
+      // cached outputs are matched by the contents of their inputs.
+      setup.action_cache = true;
+      setup.content_hash = true;
+    } else if (*arg_it == "--action-cache-size") {
+      arg_it++;
+      if (arg_it == args.end() || arg_it->empty() ||
+          arg_it->find_first_not_of("0123456789") != std::string::npos) {
+        std::cerr << "error: no valid cache size was specified. cannot proceed."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      setup.action_cache_size = std::stoull(*arg_it) << 20;
+    } else if (*arg_it == "--eager-globals") {
+      setup.eager_globals = true;
+    } else if (*arg_it == "--pipelined") {
+      setup.pipelined = true;
     } else if (*arg_it == "--version") {
       std::cout << "qvickbuild " << KALPlatform::get_version_string()
                 << std::endl;
@@ -51,6 +70,16 @@ int main(int argc, char **argv) {
                    "  --log-standard: sets logging level to standard\n"
                    "  --log-verbose: sets logging level to verbose\n"
                    "  --dry-run: prevents the execution of any commands\n"
+                   "  --content-hash: decides whether tasks are up to date "
+                   "using file contents\n"
+                   "  --action-cache: reuses task outputs from the shared "
+                   "cache, implies --content-hash\n"
+                   "  --action-cache-size [MiB]: limits the size of the "
+                   "shared cache\n"
+                   "  --eager-globals: evaluates globs ahead of the build, "
+                   "in parallel\n"
+                   "  --pipelined: starts running tasks before every task has "
+                   "been evaluated\n"
                    "  --version: emits qvickbuild version\n"
                    "  --help: shows this message and exits\n";
       exit(EXIT_SUCCESS);
@@ -11,65 +11,65 @@
 #include <thread>
 #include <variant>
 
+thread_local std::vector<FrameRecord> ContextStack::local_stack = {};
 std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>>
-    ContextStack::stack = {};
+    ContextStack::published = {};
 std::mutex ContextStack::stack_lock;
-std::unordered_map<size_t, bool> ContextStack::frozen = {};
 
-void ContextStack::freeze() {
-  std::thread::id thread_id = std::this_thread::get_id();
-  size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
-  std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  ContextStack::frozen[thread_hash] = true;
-}
-bool ContextStack::is_frozen() {
-  std::thread::id thread_id = std::this_thread::get_id();
-  size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
-  std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  return ContextStack::frozen[thread_hash];
-}
 std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>>
 ContextStack::dump_stack() {
-  return stack;
-}
-std::vector<std::shared_ptr<Frame>> ContextStack::export_local_stack() {
-  std::thread::id thread_id = std::this_thread::get_id();
-  size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
   std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  return ContextStack::stack[thread_hash];
-}
-void ContextStack::import_local_stack(
-    std::vector<std::shared_ptr<Frame>> local_stack) {
+  return published;
+}
+std::vector<FrameRecord> ContextStack::export_local_stack() {
+  return local_stack;
+}
+void ContextStack::import_local_stack(std::vector<FrameRecord> frames) {
+  local_stack = std::move(frames);
+}
+
+void ContextStack::publish() {
+  std::vector<std::shared_ptr<Frame>> frames;
+  frames.reserve(local_stack.size());
+  for (FrameRecord const &record : local_stack) {
+    std::string name(record.name);
+    switch (record.kind) {
+    case FrameKind::EntryBuild:
+      frames.push_back(
+          std::make_shared<EntryBuildFrame>(name, record.reference));
+      break;
+    case FrameKind::DependencyBuild:
+      frames.push_back(
+          std::make_shared<DependencyBuildFrame>(name, record.reference));
+      break;
+    case FrameKind::IdentifierEvaluate:
+      frames.push_back(
+          std::make_shared<IdentifierEvaluateFrame>(name, record.reference));
+      break;
+    }
+  }
+
   std::thread::id thread_id = std::this_thread::get_id();
   size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
   std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  ContextStack::stack[thread_hash] = local_stack;
+  ContextStack::published[thread_hash] = std::move(frames);
 }
 
 // frameguard implementation.
-template <typename F> FrameGuard::FrameGuard(F frame) {
-  if (ContextStack::is_frozen())
-    return;
-  std::shared_ptr<F> frame_ptr = std::make_shared<F>(frame);
-  std::thread::id thread_id = std::this_thread::get_id();
-  thread_hash = std::hash<std::thread::id>{}(thread_id);
-  std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  ContextStack::stack[thread_hash].push_back(std::move(frame_ptr));
+FrameGuard::FrameGuard(FrameKind kind, std::string_view name,
+                       StreamReference reference) {
+  ContextStack::local_stack.push_back({kind, name, reference});
 }
 
 FrameGuard::~FrameGuard() {
-  if (ContextStack::is_frozen())
-    return;
-  std::unique_lock<std::mutex> guard(ContextStack::stack_lock);
-  guard.unlock();
-  assert(ContextStack::stack.size() != 0 &&
+  assert(ContextStack::local_stack.size() != 0 &&
          "attempt to erase a non-existent context frame pointer");
-  guard.lock();
-  ContextStack::stack[thread_hash].pop_back();
+  ContextStack::local_stack.pop_back();
 }
 
 // specific build frames.
-std::string EntryBuildFrame::render_frame(std::vector<unsigned char> config) {
+std::string
+EntryBuildFrame::render_frame(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, reference);
   return std::format("building task '{}' {}(defined on line {}){}", task,
@@ -81,10 +81,8 @@ EntryBuildFrame::EntryBuildFrame(std::string task, StreamReference reference) {
   this->reference = reference;
 }
 
-std::string EntryBuildFrame::get_unique_identifier() { return task; }
-
 std::string
-DependencyBuildFrame::render_frame(std::vector<unsigned char> config) {
+DependencyBuildFrame::render_frame(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, reference);
   return std::format(
@@ -97,10 +95,8 @@ DependencyBuildFrame::DependencyBuildFrame(std::string task,
   this->reference = reference;
 }
 
-std::string DependencyBuildFrame::get_unique_identifier() { return task; }
-
 std::string
-IdentifierEvaluateFrame::render_frame(std::vector<unsigned char> config) {
+IdentifierEvaluateFrame::render_frame(std::span<unsigned char const> config) {
   ReferenceView identifier_view =
       ErrorRenderer::get_reference_view(config, reference);
   return std::format("evaluating variable '{}' {}(referred to on line {}){}",
@@ -113,39 +109,45 @@ IdentifierEvaluateFrame::IdentifierEvaluateFrame(std::string identifier,
   this->reference = reference;
 }
 
-std::string IdentifierEvaluateFrame::get_unique_identifier() {
-  return identifier;
-}
-
 // internal standardized methods.
+std::mutex ErrorRenderer::line_index_lock;
+std::span<unsigned char const> ErrorRenderer::line_index_config = {};
+std::vector<size_t> ErrorRenderer::line_index = {};
+
 ReferenceView
-ErrorRenderer::get_reference_view(std::vector<unsigned char> config,
+ErrorRenderer::get_reference_view(std::span<unsigned char const> config,
                                   StreamReference reference) {
-  // get line from config file & find line number
-  size_t line_start = 0;
-  size_t line_end = 0;
-  size_t line_num = 1;
-  for (size_t i = 0; i < reference.index && i < config.size(); i++) {
-    if (config[i] == '\n') {
-      line_start = i + 1;
-      line_num++;
+  // a failed build renders a reference for every frame of every thread, so
+  // the config is only scanned for line breaks once.
+  std::unique_lock<std::mutex> guard(ErrorRenderer::line_index_lock);
+  if (line_index_config.data() != config.data() ||
+      line_index_config.size() != config.size() || line_index.empty()) {
+    line_index = {0};
+    for (size_t i = 0; i < config.size(); i++) {
+      if (config[i] == '\n')
+        line_index.push_back(i + 1);
     }
+    line_index_config = config;
   }
-  line_end = line_start;
-  for (size_t i = line_start; config[i] != '\n' && i < config.size(); i++)
-    line_end = i;
-  std::vector<unsigned char> line_prefix_vec(config.begin() + line_start,
-                                             config.begin() + reference.index);
-  std::string line_prefix(line_prefix_vec.begin(), line_prefix_vec.end());
-  std::vector<unsigned char> line_ref_vec(config.begin() + reference.index,
-                                          config.begin() + reference.index +
-                                              reference.length);
-  std::string line_ref(line_ref_vec.begin(), line_ref_vec.end());
-  std::vector<unsigned char> line_suffix_vec(config.begin() + reference.index +
-                                                 reference.length,
-                                             config.begin() + line_end + 1);
-  std::string line_suffix(line_suffix_vec.begin(), line_suffix_vec.end());
-  return {line_prefix, line_ref, line_suffix, line_num};
+
+  // get line from config file & find line number
+  size_t index = std::min(reference.index, config.size());
+  auto line_it = std::ranges::upper_bound(line_index, index) - 1;
+  size_t line_num = line_it - line_index.begin() + 1;
+  size_t line_start = *line_it;
+  size_t line_break =
+      line_it + 1 != line_index.end() ? *(line_it + 1) - 1 : config.size();
+  guard.unlock();
+  size_t line_end = line_break > line_start ? line_break - 1 : line_start;
+
+  auto substring = [&](size_t begin, size_t end) {
+    begin = std::min(begin, config.size());
+    end = std::clamp(end, begin, config.size());
+    return std::string(config.begin() + begin, config.begin() + end);
+  };
+  return {substring(line_start, index),
+          substring(index, index + reference.length),
+          substring(index + reference.length, line_end + 1), line_num};
 }
 
 std::string ErrorRenderer::get_rendered_view(ReferenceView reference_view,
@@ -262,7 +264,7 @@ ENoMatchingIdentifier::ENoMatchingIdentifier(Identifier identifier) {
 }
 
 std::string
-ENoMatchingIdentifier::render_error(std::vector<unsigned char> config) {
+ENoMatchingIdentifier::render_error(std::span<unsigned char const> config) {
   ReferenceView identifier_view =
       ErrorRenderer::get_reference_view(config, identifier.reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -283,7 +285,8 @@ EListTypeMismatch::EListTypeMismatch(
     std::variant<IList<IString>, IList<IBool>> list, IValue &ivalue)
     : list(list), faulty_ivalue(ivalue.clone()) {}
 
-std::string EListTypeMismatch::render_error(std::vector<unsigned char> config) {
+std::string
+EListTypeMismatch::render_error(std::span<unsigned char const> config) {
   ReferenceView obj_view =
       ErrorRenderer::get_reference_view(config, faulty_ivalue->reference);
   std::string rendered_view =
@@ -307,7 +310,7 @@ EReplaceTypeMismatch::EReplaceTypeMismatch(Replace replace,
 }
 
 std::string
-EReplaceTypeMismatch::render_error(std::vector<unsigned char> config) {
+EReplaceTypeMismatch::render_error(std::span<unsigned char const> config) {
   ReferenceView obj_view =
       ErrorRenderer::get_reference_view(config, faulty_ivalue->reference);
   std::string rendered_view =
@@ -326,7 +329,7 @@ EReplaceChunksLength::EReplaceChunksLength(IValue &replacement)
     : replacement(replacement.clone()) {}
 
 std::string
-EReplaceChunksLength::render_error(std::vector<unsigned char> config) {
+EReplaceChunksLength::render_error(std::span<unsigned char const> config) {
   StreamReference ref = replacement->reference;
   ReferenceView repl_view = ErrorRenderer::get_reference_view(config, ref);
   std::string rendered_view =
@@ -349,7 +352,7 @@ EVariableTypeMismatch::EVariableTypeMismatch(IValue &variable,
 }
 
 std::string
-EVariableTypeMismatch::render_error(std::vector<unsigned char> config) {
+EVariableTypeMismatch::render_error(std::span<unsigned char const> config) {
   StreamReference var_ref = variable->reference;
   ReferenceView var_view = ErrorRenderer::get_reference_view(config, var_ref);
   std::string rendered_view =
@@ -372,7 +375,8 @@ ENonZeroProcess::ENonZeroProcess(std::string cmdline,
   this->reference = reference;
 }
 
-std::string ENonZeroProcess::render_error(std::vector<unsigned char> config) {
+std::string
+ENonZeroProcess::render_error(std::span<unsigned char const> config) {
   ReferenceView ref_view = ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
       ErrorRenderer::get_rendered_view(ref_view, "command defined here");
@@ -390,7 +394,8 @@ EProcessInternal::EProcessInternal(std::string cmdline,
   this->reference = reference;
 }
 
-std::string EProcessInternal::render_error(std::vector<unsigned char> config) {
+std::string
+EProcessInternal::render_error(std::span<unsigned char const> config) {
   ReferenceView ref_view = ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
       ErrorRenderer::get_rendered_view(ref_view, "command defined here");
@@ -410,7 +415,7 @@ ETaskNotFound::ETaskNotFound(std::string task_name) {
   this->task_name = task_name;
 }
 
-std::string ETaskNotFound::render_error(std::vector<unsigned char>) {
+std::string ETaskNotFound::render_error(std::span<unsigned char const>) {
   return std::format("{}{}error:{}{} task '{}' does not exist.{}",
                      CLIColour::red(), CLIColour::bold(), CLIColour::reset(),
                      CLIColour::bold(), task_name, CLIColour::reset());
@@ -418,7 +423,7 @@ std::string ETaskNotFound::render_error(std::vector<unsigned char>) {
 
 char const *ETaskNotFound::get_exception_msg() { return "Task not found"; }
 
-std::string ENoTasks::render_error(std::vector<unsigned char>) {
+std::string ENoTasks::render_error(std::span<unsigned char const>) {
   return std::format("{}{}error:{}{} no tasks are defined.{}", CLIColour::red(),
                      CLIColour::bold(), CLIColour::reset(), CLIColour::bold(),
                      CLIColour::reset());
@@ -428,7 +433,8 @@ char const *ENoTasks::get_exception_msg() { return "No tasks are defined"; }
 
 EAmbiguousTask::EAmbiguousTask(Task task) { this->task = task; }
 
-std::string EAmbiguousTask::render_error(std::vector<unsigned char> config) {
+std::string
+EAmbiguousTask::render_error(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, task.reference);
   std::string rendered_view =
@@ -449,7 +455,8 @@ EDependencyFailed::EDependencyFailed(IValue &dep, std::string dependency_value)
   this->dependency_value = dependency_value;
 }
 
-std::string EDependencyFailed::render_error(std::vector<unsigned char> config) {
+std::string
+EDependencyFailed::render_error(std::span<unsigned char const> config) {
   StreamReference ref = dependency->reference;
   ReferenceView dep_view = ErrorRenderer::get_reference_view(config, ref);
   std::string rendered_view =
@@ -471,7 +478,8 @@ EInvalidSymbol::EInvalidSymbol(StreamReference reference, std::string symbol) {
   this->symbol = symbol;
 }
 
-std::string EInvalidSymbol::render_error(std::vector<unsigned char> config) {
+std::string
+EInvalidSymbol::render_error(std::span<unsigned char const> config) {
   ReferenceView ref_view = ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
       ErrorRenderer::get_rendered_view(ref_view, "symbol encountered here");
@@ -488,7 +496,8 @@ EInvalidLiteral::EInvalidLiteral(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string EInvalidLiteral::render_error(std::vector<unsigned char> config) {
+std::string
+EInvalidLiteral::render_error(std::span<unsigned char const> config) {
   ReferenceView ref_view = ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
       ErrorRenderer::get_rendered_view(ref_view, "invalid symbol here");
@@ -504,7 +513,8 @@ EInvalidGrammar::EInvalidGrammar(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string EInvalidGrammar::render_error(std::vector<unsigned char> config) {
+std::string
+EInvalidGrammar::render_error(std::span<unsigned char const> config) {
   ReferenceView ref_view = ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
       ErrorRenderer::get_rendered_view(ref_view, "syntax encountered here");
@@ -518,7 +528,7 @@ char const *EInvalidGrammar::get_exception_msg() { return "Invalid grammar"; }
 
 ENoValue::ENoValue(Identifier identifier) { this->identifier = identifier; }
 
-std::string ENoValue::render_error(std::vector<unsigned char> config) {
+std::string ENoValue::render_error(std::span<unsigned char const> config) {
   ReferenceView decl_view =
       ErrorRenderer::get_reference_view(config, identifier.reference);
   std::string rendered_view =
@@ -536,7 +546,7 @@ ENoLinestop::ENoLinestop(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string ENoLinestop::render_error(std::vector<unsigned char> config) {
+std::string ENoLinestop::render_error(std::span<unsigned char const> config) {
   ReferenceView line_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -554,7 +564,7 @@ ENoIterator::ENoIterator(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string ENoIterator::render_error(std::vector<unsigned char> config) {
+std::string ENoIterator::render_error(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -572,7 +582,7 @@ ENoTaskOpen::ENoTaskOpen(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string ENoTaskOpen::render_error(std::vector<unsigned char> config) {
+std::string ENoTaskOpen::render_error(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
@@ -592,7 +602,7 @@ ENoTaskClose::ENoTaskClose(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string ENoTaskClose::render_error(std::vector<unsigned char> config) {
+std::string ENoTaskClose::render_error(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
@@ -612,7 +622,8 @@ EInvalidListEnd::EInvalidListEnd(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string EInvalidListEnd::render_error(std::vector<unsigned char> config) {
+std::string
+EInvalidListEnd::render_error(std::span<unsigned char const> config) {
   ReferenceView separator_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -631,7 +642,7 @@ ENoReplacementIdentifier::ENoReplacementIdentifier(StreamReference reference) {
 }
 
 std::string
-ENoReplacementIdentifier::render_error(std::vector<unsigned char> config) {
+ENoReplacementIdentifier::render_error(std::span<unsigned char const> config) {
   ReferenceView modify_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -652,7 +663,7 @@ ENoReplacementOriginal::ENoReplacementOriginal(StreamReference reference) {
 }
 
 std::string
-ENoReplacementOriginal::render_error(std::vector<unsigned char> config) {
+ENoReplacementOriginal::render_error(std::span<unsigned char const> config) {
   ReferenceView modify_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -673,7 +684,7 @@ ENoReplacementArrow::ENoReplacementArrow(StreamReference reference) {
 }
 
 std::string
-ENoReplacementArrow::render_error(std::vector<unsigned char> config) {
+ENoReplacementArrow::render_error(std::span<unsigned char const> config) {
   ReferenceView original_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -695,7 +706,7 @@ ENoReplacementReplacement::ENoReplacementReplacement(
 }
 
 std::string
-ENoReplacementReplacement::render_error(std::vector<unsigned char> config) {
+ENoReplacementReplacement::render_error(std::span<unsigned char const> config) {
   ReferenceView arrow_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -717,7 +728,7 @@ EInvalidEscapedExpression::EInvalidEscapedExpression(
 }
 
 std::string
-EInvalidEscapedExpression::render_error(std::vector<unsigned char> config) {
+EInvalidEscapedExpression::render_error(std::span<unsigned char const> config) {
   ReferenceView expr_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
@@ -738,7 +749,7 @@ ENoExpressionClose::ENoExpressionClose(StreamReference reference) {
 }
 
 std::string
-ENoExpressionClose::render_error(std::vector<unsigned char> config) {
+ENoExpressionClose::render_error(std::span<unsigned char const> config) {
   ReferenceView expr_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -758,7 +769,8 @@ EEmptyExpression::EEmptyExpression(StreamReference reference) {
   this->reference = reference;
 }
 
-std::string EEmptyExpression::render_error(std::vector<unsigned char> config) {
+std::string
+EEmptyExpression::render_error(std::span<unsigned char const> config) {
   ReferenceView expr_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view = ErrorRenderer::get_rendered_view(
@@ -774,7 +786,7 @@ char const *EEmptyExpression::get_exception_msg() { return "Empty expression"; }
 
 EInvalidInputFile::EInvalidInputFile(std::string path) { this->path = path; }
 
-std::string EInvalidInputFile::render_error(std::vector<unsigned char>) {
+std::string EInvalidInputFile::render_error(std::span<unsigned char const>) {
   return std::format("{}{}error:{}{} config file '{}' is unreachable.{}",
                      CLIColour::red(), CLIColour::bold(), CLIColour::reset(),
                      CLIColour::bold(), path, CLIColour::reset());
@@ -791,7 +803,7 @@ EInvalidEscapeCode::EInvalidEscapeCode(unsigned char code,
 }
 
 std::string
-EInvalidEscapeCode::render_error(std::vector<unsigned char> config) {
+EInvalidEscapeCode::render_error(std::span<unsigned char const> config) {
   ReferenceView code_view =
       ErrorRenderer::get_reference_view(config, reference);
   std::string rendered_view =
@@ -810,7 +822,7 @@ char const *EInvalidEscapeCode::get_exception_msg() {
 EAdjacentWildcards::EAdjacentWildcards(IString istring) : istring(istring) {}
 
 std::string
-EAdjacentWildcards::render_error(std::vector<unsigned char> config) {
+EAdjacentWildcards::render_error(std::span<unsigned char const> config) {
   ReferenceView str_view =
       ErrorRenderer::get_reference_view(config, istring.reference);
   std::string rendered_view =
@@ -831,7 +843,7 @@ ERecursiveVariable::ERecursiveVariable(Identifier identifier) {
 }
 
 std::string
-ERecursiveVariable::render_error(std::vector<unsigned char> config) {
+ERecursiveVariable::render_error(std::span<unsigned char const> config) {
   ReferenceView var_view =
       ErrorRenderer::get_reference_view(config, identifier.reference);
   std::string rendered_view =
@@ -853,7 +865,8 @@ ERecursiveTask::ERecursiveTask(Task task, std::string dependency_value) {
   this->dependency_value = dependency_value;
 }
 
-std::string ERecursiveTask::render_error(std::vector<unsigned char> config) {
+std::string
+ERecursiveTask::render_error(std::span<unsigned char const> config) {
   ReferenceView task_view =
       ErrorRenderer::get_reference_view(config, task.reference);
   std::string rendered_view =
@@ -876,7 +889,7 @@ EDuplicateIdentifier::EDuplicateIdentifier(Identifier identifier_1,
 }
 
 std::string
-EDuplicateIdentifier::render_error(std::vector<unsigned char> config) {
+EDuplicateIdentifier::render_error(std::span<unsigned char const> config) {
   ReferenceView identifier_1_view =
       ErrorRenderer::get_reference_view(config, identifier_1.reference);
   ReferenceView identifier_2_view =
@@ -901,7 +914,8 @@ EDuplicateTask::EDuplicateTask(Task task_1, Task task_2, std::string key) {
   this->key = key;
 }
 
-std::string EDuplicateTask::render_error(std::vector<unsigned char> config) {
+std::string
+EDuplicateTask::render_error(std::span<unsigned char const> config) {
   ReferenceView task_1_view =
       ErrorRenderer::get_reference_view(config, task_1.reference);
   ReferenceView task_2_view =
@@ -928,7 +942,7 @@ ErrorHandler::get_errors() {
 };
 
 template <typename B> void ErrorHandler::halt [[noreturn]] (B build_error) {
-  ContextStack::freeze();
+  ContextStack::publish();
   std::thread::id thread_id = std::this_thread::get_id();
   size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
 
@@ -939,7 +953,7 @@ template <typename B> void ErrorHandler::halt [[noreturn]] (B build_error) {
 }
 
 template <typename B> void ErrorHandler::soft_report(B build_error) {
-  ContextStack::freeze();
+  ContextStack::publish();
   std::thread::id thread_id = std::this_thread::get_id();
   size_t thread_hash = std::hash<std::thread::id>{}(thread_id);
 
@@ -1039,6 +1053,3 @@ template void ErrorHandler::soft_report<ERecursiveTask>(ERecursiveTask);
 template void
     ErrorHandler::soft_report<EDuplicateIdentifier>(EDuplicateIdentifier);
 template void ErrorHandler::soft_report<EDuplicateTask>(EDuplicateTask);
-template FrameGuard::FrameGuard(IdentifierEvaluateFrame);
-template FrameGuard::FrameGuard(EntryBuildFrame);
-template FrameGuard::FrameGuard(DependencyBuildFrame);
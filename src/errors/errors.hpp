@@ -3,8 +3,12 @@
 
 #include "../lexer/tracking.hpp"
 #include "types.hpp"
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -16,8 +20,14 @@ struct ReferenceView {
 };
 
 class ErrorRenderer {
+private:
+  // offset of every line in the config, built once an error is rendered.
+  static std::mutex line_index_lock;
+  static std::span<unsigned char const> line_index_config;
+  static std::vector<size_t> line_index;
+
 public:
-  static ReferenceView get_reference_view(std::vector<unsigned char> config,
+  static ReferenceView get_reference_view(std::span<unsigned char const> config,
                                           StreamReference reference);
   static std::string get_rendered_view(ReferenceView reference_view,
                                        std::string msg);
@@ -50,34 +60,50 @@ public:
   const char *what() const noexcept override { return details; };
 };
 
+// the kind of frame recorded, which determines how it is rendered.
+enum class FrameKind : uint8_t {
+  EntryBuild,
+  DependencyBuild,
+  IdentifierEvaluate,
+};
+
+// a frame as it is recorded while building. the name is borrowed from the
+// caller of FrameGuard, which outlives the frame, and is only copied once the
+// frame is published.
+struct FrameRecord {
+  FrameKind kind;
+  std::string_view name;
+  StreamReference reference;
+};
+
 // api-facing context stack getter.
 class ContextStack {
   friend class FrameGuard;
 
 private:
-  // thread hash, frames
+  // frames of the calling thread. the buffer is reused by every frame, so
+  // recording one neither allocates nor locks.
+  static thread_local std::vector<FrameRecord> local_stack;
+  // thread hash, frames. only written once an error is reported.
   static std::mutex stack_lock;
-  static std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>> stack;
-  static std::unordered_map<size_t, bool> frozen;
+  static std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>>
+      published;
 
 public:
   static std::unordered_map<size_t, std::vector<std::shared_ptr<Frame>>>
   dump_stack();
-  static std::vector<std::shared_ptr<Frame>> export_local_stack();
-  static void import_local_stack(std::vector<std::shared_ptr<Frame>>);
+  static std::vector<FrameRecord> export_local_stack();
+  static void import_local_stack(std::vector<FrameRecord>);
 
-  static void freeze();
-  static bool is_frozen();
+  // copies the frames of the calling thread into the error report.
+  static void publish();
 };
 
 // api-facing context stack frame handler.
 class FrameGuard {
-private:
-  size_t thread_hash;
-
 public:
   FrameGuard() = delete;
-  template <typename F> FrameGuard(F frame);
+  FrameGuard(FrameKind kind, std::string_view name, StreamReference reference);
   ~FrameGuard();
 };
 
@@ -4,12 +4,13 @@
 #include "../interpreter/types.hpp"
 #include "../lexer/tracking.hpp"
 #include "../parser/types.hpp"
+#include <span>
 #include <string>
 #include <vector>
 
 class BuildError {
 public:
-  virtual std::string render_error(std::vector<unsigned char> config) = 0;
+  virtual std::string render_error(std::span<unsigned char const> config) = 0;
   virtual char const *get_exception_msg() = 0;
   virtual ~BuildError() = default;
 };
@@ -19,7 +20,7 @@ private:
   Identifier identifier;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoMatchingIdentifier() = delete;
   ENoMatchingIdentifier(Identifier);
@@ -31,7 +32,7 @@ private:
   std::unique_ptr<IValue> faulty_ivalue;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EListTypeMismatch() = delete;
   EListTypeMismatch(std::variant<IList<IString>, IList<IBool>>, IValue &);
@@ -43,7 +44,7 @@ private:
   std::unique_ptr<IValue> faulty_ivalue;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EReplaceTypeMismatch() = delete;
   EReplaceTypeMismatch(Replace, IValue &);
@@ -54,7 +55,7 @@ private:
   std::unique_ptr<IValue> replacement;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EReplaceChunksLength() = delete;
   EReplaceChunksLength(IValue &);
@@ -66,7 +67,7 @@ private:
   std::string expected_type;
 
 public:
-  std::string render_error(std::vector<unsigned char> config);
+  std::string render_error(std::span<unsigned char const> config);
   char const *get_exception_msg();
   EVariableTypeMismatch(IValue &, std::string);
 };
@@ -77,7 +78,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENonZeroProcess() = delete;
   ENonZeroProcess(std::string, StreamReference);
@@ -89,7 +90,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EProcessInternal() = delete;
   EProcessInternal(std::string, StreamReference);
@@ -100,7 +101,7 @@ private:
   std::string task_name;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ETaskNotFound() = delete;
   ETaskNotFound(std::string);
@@ -108,7 +109,7 @@ public:
 
 class ENoTasks : public BuildError {
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
 };
 
@@ -117,7 +118,7 @@ private:
   Task task;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EAmbiguousTask() = delete;
   EAmbiguousTask(Task);
@@ -129,7 +130,7 @@ private:
   std::string dependency_value;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EDependencyFailed() = delete;
   EDependencyFailed(IValue &, std::string);
@@ -141,7 +142,7 @@ private:
   std::string symbol;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidSymbol() = delete;
   EInvalidSymbol(StreamReference, std::string);
@@ -152,7 +153,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidGrammar() = delete;
   EInvalidGrammar(StreamReference);
@@ -163,7 +164,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidLiteral() = delete;
   EInvalidLiteral(StreamReference);
@@ -174,7 +175,7 @@ private:
   Identifier identifier;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoValue() = delete;
   ENoValue(Identifier);
@@ -185,7 +186,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoLinestop() = delete;
   ENoLinestop(StreamReference);
@@ -196,7 +197,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoIterator() = delete;
   ENoIterator(StreamReference);
@@ -207,7 +208,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoTaskOpen() = delete;
   ENoTaskOpen(StreamReference);
@@ -218,7 +219,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoTaskClose() = delete;
   ENoTaskClose(StreamReference);
@@ -229,7 +230,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidListEnd() = delete;
   EInvalidListEnd(StreamReference);
@@ -240,7 +241,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoReplacementIdentifier() = delete;
   ENoReplacementIdentifier(StreamReference);
@@ -251,7 +252,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoReplacementOriginal() = delete;
   ENoReplacementOriginal(StreamReference);
@@ -262,7 +263,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoReplacementArrow() = delete;
   ENoReplacementArrow(StreamReference);
@@ -273,7 +274,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoReplacementReplacement() = delete;
   ENoReplacementReplacement(StreamReference);
@@ -284,7 +285,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidEscapedExpression() = delete;
   EInvalidEscapedExpression(StreamReference);
@@ -295,7 +296,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ENoExpressionClose() = delete;
   ENoExpressionClose(StreamReference);
@@ -306,7 +307,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EEmptyExpression() = delete;
   EEmptyExpression(StreamReference);
@@ -317,7 +318,7 @@ private:
   std::string path;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidInputFile() = delete;
   EInvalidInputFile(std::string);
@@ -329,7 +330,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EInvalidEscapeCode() = delete;
   EInvalidEscapeCode(unsigned char, StreamReference);
@@ -340,7 +341,7 @@ private:
   IString istring;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EAdjacentWildcards() = delete;
   EAdjacentWildcards(IString);
@@ -351,7 +352,7 @@ private:
   Identifier identifier;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ERecursiveVariable() = delete;
   ERecursiveVariable(Identifier);
@@ -363,7 +364,7 @@ private:
   std::string dependency_value;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   ERecursiveTask() = delete;
   ERecursiveTask(Task, std::string);
@@ -375,7 +376,7 @@ private:
   Identifier identifier_2;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EDuplicateIdentifier() = delete;
   EDuplicateIdentifier(Identifier, Identifier);
@@ -387,7 +388,7 @@ class EDuplicateTask : public BuildError {
   std::string key;
 
 public:
-  std::string render_error(std::vector<unsigned char> config) override;
+  std::string render_error(std::span<unsigned char const> config) override;
   char const *get_exception_msg() override;
   EDuplicateTask() = delete;
   EDuplicateTask(Task, Task, std::string);
@@ -396,8 +397,7 @@ public:
 // a single frame in the context stack.
 class Frame {
 public:
-  virtual std::string render_frame(std::vector<unsigned char> config) = 0;
-  virtual std::string get_unique_identifier() = 0;
+  virtual std::string render_frame(std::span<unsigned char const> config) = 0;
   virtual ~Frame() = default;
 };
 
@@ -407,8 +407,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_frame(std::vector<unsigned char> config) override;
-  std::string get_unique_identifier() override;
+  std::string render_frame(std::span<unsigned char const> config) override;
   EntryBuildFrame() = delete;
   EntryBuildFrame(std::string task, StreamReference reference);
 };
@@ -419,8 +418,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_frame(std::vector<unsigned char> config) override;
-  std::string get_unique_identifier() override;
+  std::string render_frame(std::span<unsigned char const> config) override;
   DependencyBuildFrame() = delete;
   DependencyBuildFrame(std::string task, StreamReference reference);
 };
@@ -431,8 +429,7 @@ private:
   StreamReference reference;
 
 public:
-  std::string render_frame(std::vector<unsigned char> config) override;
-  std::string get_unique_identifier() override;
+  std::string render_frame(std::span<unsigned char const> config) override;
   IdentifierEvaluateFrame() = delete;
   IdentifierEvaluateFrame(std::string identifier, StreamReference reference);
 };
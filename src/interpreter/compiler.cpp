@@ -0,0 +1,130 @@
+#include "compiler.hpp"
+#include <cassert>
+
+#define IMMUTABLE true
+
+Program Compiler::compile(ASTObject const &ast_object) {
+  Compiler compiler;
+  // any expression is evaluated with globbing enabled, see the interpreter.
+  compiler.compile_object(ast_object, true);
+  return std::move(compiler.m_program);
+}
+
+// replacement operators disable globbing for their operands, as the wildcards
+// need to be handled by the operator itself. this is purely lexical, except
+// for identifiers, which always enable globbing again.
+void Compiler::compile_object(ASTObject const &ast_object, bool use_globbing) {
+  std::vector<Instruction> &code = m_program.code;
+  std::vector<std::shared_ptr<IValue>> &constants = m_program.constants;
+
+  if (Identifier const *identifier = std::get_if<Identifier>(&ast_object)) {
+    code.push_back({Opcode::Load,
+                    static_cast<uint32_t>(m_program.identifiers.size()),
+                    identifier->reference});
+    m_program.identifiers.push_back(*identifier);
+
+  } else if (Literal const *literal = std::get_if<Literal>(&ast_object)) {
+    code.push_back({Opcode::Constant, static_cast<uint32_t>(constants.size()),
+                    literal->reference});
+    constants.push_back(std::make_shared<IString>(
+        literal->content, literal->reference, IMMUTABLE));
+
+  } else if (Boolean const *boolean = std::get_if<Boolean>(&ast_object)) {
+    code.push_back({Opcode::Constant, static_cast<uint32_t>(constants.size()),
+                    boolean->reference});
+    constants.push_back(std::make_shared<IBool>(
+        boolean->content, boolean->reference, IMMUTABLE));
+
+  } else if (FormattedLiteral const *formatted_literal =
+                 std::get_if<FormattedLiteral>(&ast_object)) {
+    // formatted literals without any identifiers are known in advance.
+    bool constant = true;
+    std::string folded;
+    for (ASTObject const &content : formatted_literal->contents) {
+      Literal const *literal = std::get_if<Literal>(&content);
+      constant &= literal != nullptr;
+      if (literal)
+        folded += literal->content;
+    }
+
+    if (constant) {
+      code.push_back({Opcode::Constant,
+                      static_cast<uint32_t>(constants.size()),
+                      formatted_literal->reference});
+      constants.push_back(std::make_shared<IString>(
+          folded, formatted_literal->reference, IMMUTABLE));
+      // the filesystem may change between evaluations.
+      if (use_globbing && folded.find('*') != std::string::npos)
+        code.push_back({Opcode::Glob, 0, formatted_literal->reference});
+      return;
+    }
+
+    for (ASTObject const &content : formatted_literal->contents)
+      compile_object(content, use_globbing);
+    code.push_back({Opcode::Format,
+                    static_cast<uint32_t>(formatted_literal->contents.size()),
+                    formatted_literal->reference});
+    if (use_globbing)
+      code.push_back({Opcode::Glob, 0, formatted_literal->reference});
+
+  } else if (List const *list = std::get_if<List>(&ast_object)) {
+    assert(list->contents.size() > 0 && "attempt to compile empty list");
+    size_t first_instruction = code.size();
+    for (ASTObject const &content : list->contents)
+      compile_object(content, use_globbing);
+
+    std::optional<std::shared_ptr<IValue>> folded =
+        fold_list(*list, first_instruction);
+    if (folded) {
+      code.resize(first_instruction);
+      code.push_back({Opcode::Constant,
+                      static_cast<uint32_t>(constants.size()),
+                      list->reference});
+      constants.push_back(*folded);
+      return;
+    }
+    code.push_back({Opcode::List,
+                    static_cast<uint32_t>(list->contents.size()),
+                    list->reference});
+
+  } else if (Replace const *replace = std::get_if<Replace>(&ast_object)) {
+    compile_object(*replace->input, false);
+    compile_object(*replace->filter, false);
+    compile_object(*replace->product, false);
+    code.push_back({Opcode::Replace,
+                    static_cast<uint32_t>(m_program.replaces.size()),
+                    replace->reference});
+    m_program.replaces.push_back(*replace);
+  }
+}
+
+// lists consisting solely of constants of the same type are folded into a
+// single constant. anything else, e.g. a type mismatch, is left to be
+// reported during evaluation.
+std::optional<std::shared_ptr<IValue>>
+Compiler::fold_list(List const &list, size_t first_instruction) {
+  std::vector<Instruction> const &code = m_program.code;
+  if (code.size() - first_instruction != list.contents.size())
+    return std::nullopt;
+
+  std::vector<IString> strings;
+  std::vector<IBool> bools;
+  for (size_t i = first_instruction; i < code.size(); i++) {
+    if (code[i].opcode != Opcode::Constant)
+      return std::nullopt;
+    IValue &value = *m_program.constants[code[i].operand];
+    if (value.get_type() == IType::IString)
+      strings.push_back(dynamic_cast<IString &>(value));
+    else if (value.get_type() == IType::IBool)
+      bools.push_back(dynamic_cast<IBool &>(value));
+    else
+      return std::nullopt;
+  }
+
+  if (!strings.empty() && !bools.empty())
+    return std::nullopt;
+  if (!strings.empty())
+    return std::make_shared<IList<IString>>(strings, list.reference,
+                                            IMMUTABLE);
+  return std::make_shared<IList<IBool>>(bools, list.reference, IMMUTABLE);
+}
@@ -0,0 +1,49 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include "../parser/types.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// expressions are compiled into a flat sequence of instructions operating on a
+// stack of values, which avoids walking the AST for every task iteration.
+enum class Opcode : uint8_t {
+  Constant, // pushes constants[operand].
+  Load,     // pushes the value of identifiers[operand].
+  Format,   // concatenates the top `operand` values into a string.
+  Glob,     // expands the string on top of the stack.
+  List,     // collects the top `operand` values into a list.
+  Replace,  // applies replaces[operand] to the top three values.
+};
+
+struct Instruction {
+  Opcode opcode;
+  uint32_t operand;
+  StreamReference reference;
+};
+
+struct Program {
+  std::vector<Instruction> code;
+  // immutable values, shared by every evaluation.
+  std::vector<std::shared_ptr<IValue>> constants;
+  std::vector<Identifier> identifiers;
+  // kept for error reporting.
+  std::vector<Replace> replaces;
+};
+
+class Compiler {
+private:
+  Program m_program;
+
+  void compile_object(ASTObject const &ast_object, bool use_globbing);
+  std::optional<std::shared_ptr<IValue>> fold_list(List const &list,
+                                                   size_t first_instruction);
+
+public:
+  // literals that are known at compile time are folded into constants.
+  static Program compile(ASTObject const &ast_object);
+};
+
+#endif
@@ -1,16 +1,24 @@
 #include "interpreter.hpp"
 #include "../errors/errors.hpp"
 #include "../lexer/tracking.hpp"
+#include "../system/depfile.hpp"
 #include "../system/filesystem.hpp"
+#include "../system/hashing.hpp"
 #include "../system/pipeline.hpp"
+#include "../system/paths.hpp"
 #include "../system/processes.hpp"
+#include "compiler.hpp"
 #include "literals.hpp"
 #include "static_verify.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <ranges>
+#include <span>
 
 #define OPT_DEPENDS "depends"
 #define OPT_DEPENDS_PARALLEL "depends_parallel"
@@ -19,6 +27,7 @@
 #define OPT_VISIBLE "visible"
 #define OPT_SILENT "silent"
 #define OPT_CLI "cli"
+#define OPT_DEPFILE "depfile"
 
 #define IMMUTABLE true
 #define MUTABLE false
@@ -135,120 +144,280 @@ bool IBool::operator==(IBool const other) const {
 }
 IBool::operator bool() const { return (this->content); };
 
+StringColumn::Columns &StringColumn::mutate() {
+  if (!this->columns)
+    this->columns = std::make_shared<Columns>();
+  else if (this->columns.use_count() > 1)
+    this->columns = std::make_shared<Columns>(*this->columns);
+  return *this->columns;
+}
+
+StringColumn::Run const &StringColumn::find_run(size_t i) const {
+  // the last run starting at or before i.
+  auto run_it = std::upper_bound(
+      this->columns->runs.begin(), this->columns->runs.end(), i,
+      [](size_t i, Run const &run) { return i < run.first; });
+  return *std::prev(run_it);
+}
+
+StringColumn::StringColumn(std::vector<IString> const &elements) {
+  for (IString const &element : elements)
+    push_back(element);
+}
+StringColumn::StringColumn(std::initializer_list<IString> elements) {
+  for (IString const &element : elements)
+    push_back(element);
+}
+
+size_t StringColumn::size() const {
+  return this->columns ? this->columns->offsets.size() - 1 : 0;
+}
+
+IString StringColumn::operator[](size_t i) const {
+  Run const &run = find_run(i);
+  return IString(std::string(view(i)), run.reference, run.immutable);
+}
+IString StringColumn::const_iterator::operator*() const { return (*column)[i]; }
+IString StringColumn::const_iterator::operator[](difference_type n) const {
+  return (*column)[i + n];
+}
+static_assert(std::random_access_iterator<StringColumn::const_iterator>);
+
+std::string_view StringColumn::view(size_t i) const {
+  uint32_t begin = this->columns->offsets[i];
+  uint32_t end = this->columns->offsets[i + 1];
+  return std::string_view(this->columns->characters).substr(begin,
+                                                            end - begin);
+}
+
+StreamReference StringColumn::reference(size_t i) const {
+  return find_run(i).reference;
+}
+
+StringColumn::operator std::vector<IString>() const {
+  return std::vector<IString>(begin(), end());
+}
+
+void StringColumn::push_back(std::string_view content,
+                             StreamReference reference, bool immutable) {
+  Columns &columns = mutate();
+  assert(columns.characters.size() + content.size() <= UINT32_MAX &&
+         "string column exceeds the maximum size");
+  if (columns.runs.empty() || columns.runs.back().immutable != immutable ||
+      columns.runs.back().reference.index != reference.index ||
+      columns.runs.back().reference.length != reference.length)
+    columns.runs.push_back(Run{size(), reference, immutable});
+  columns.characters.append(content);
+  columns.offsets.push_back(columns.characters.size());
+}
+void StringColumn::push_back(IString const &element) {
+  push_back(element.content, element.reference, element.immutable);
+}
+
+void StringColumn::append(StringColumn const &other) {
+  if (empty()) {
+    this->columns = other.columns; // no need to copy anything.
+    return;
+  }
+  if (other.empty())
+    return;
+  Columns &columns = mutate();
+  Columns const &other_columns = *other.columns;
+  size_t first = size();
+  uint32_t base = columns.characters.size();
+  assert(columns.characters.size() + other_columns.characters.size() <=
+             UINT32_MAX &&
+         "string column exceeds the maximum size");
+  columns.characters.append(other_columns.characters);
+  for (uint32_t offset : other_columns.offsets | std::views::drop(1))
+    columns.offsets.push_back(base + offset);
+  for (Run run : other_columns.runs) {
+    run.first += first;
+    Run const &last = columns.runs.back();
+    if (last.immutable == run.immutable &&
+        last.reference.index == run.reference.index &&
+        last.reference.length == run.reference.length)
+      continue; // continues the previous run.
+    columns.runs.push_back(run);
+  }
+}
+
+bool StringColumn::operator==(StringColumn const &other) const {
+  if (this->columns == other.columns)
+    return true;
+  if (size() != other.size())
+    return false;
+  for (size_t i = 0; i < size(); i++) {
+    if (view(i) != other.view(i))
+      return false;
+  }
+  return true;
+}
+
 template <typename T>
 IList<T>::IList(std::vector<T> contents, StreamReference reference,
                 bool immutable)
     : IValue(immutable, reference) {
-  this->contents = contents;
+  this->contents = std::move(contents);
 }
 
 template <typename T> bool IList<T>::operator==(IList const other) const {
   return this->contents == other.contents;
 }
 
-// returns true if, and only if, the passed context can reach the caller.
-bool EvaluationContext::is_reachable_by(EvaluationContext const other) const {
-  // globbing is *not* verified here because only variables are cached, and
-  // variables are by design forced to activate globbing
-  if (this->task_scope == std::nullopt)
-    return true;
-  if (this->task_scope == other.task_scope)
-    return true;
-  return false;
-}
-
-// visitor that evaluates an AST object recursively.
-struct ASTEvaluate {
+// evaluates compiled programs. the values of every program being evaluated on
+// a thread live on a single stack, which is reused between evaluations.
+struct ProgramEvaluate {
   EvaluationContext context;
   std::shared_ptr<EvaluationState> state;
-  std::unique_ptr<IValue> operator()(Identifier const &identifier);
-  std::unique_ptr<IValue> operator()(Literal const &literal);
-  std::unique_ptr<IValue> operator()(FormattedLiteral const &formatted_literal);
-  std::unique_ptr<IValue> operator()(List const &list);
-  std::unique_ptr<IValue> operator()(Boolean const &boolean);
-  std::unique_ptr<IValue> operator()(Replace const &replace);
+  std::unique_ptr<IValue> operator()(Program const &program);
+  std::unique_ptr<IValue> load(Identifier const &identifier);
 };
 
+static thread_local std::vector<std::unique_ptr<IValue>> evaluation_stack;
+
+// discards the values of a program whose evaluation was aborted.
+struct EvaluationStackGuard {
+  size_t base;
+  ~EvaluationStackGuard() { evaluation_stack.resize(base); }
+};
+
+// programs only amend shared data through the variable cache, so evaluations
+// may run concurrently.
 std::unique_ptr<IValue>
-Interpreter::evaluate_ast_object(ASTObject ast_object,
-                                 EvaluationContext context) {
-  // evaluation visitor can amend shared data in the state.
-  std::lock_guard<std::mutex> guard(evaluation_lock);
-  std::unique_ptr<IValue> value =
-      std::visit(ASTEvaluate{context, this->state}, ast_object);
-  return value;
-}
-
-std::unique_ptr<IValue> ASTEvaluate::operator()(Identifier const &identifier) {
-  FrameGuard frame(
-      IdentifierEvaluateFrame(identifier.content, identifier.reference));
-
-  // check whether we're shooting ourselves and the stack in the foot.
-  bool recursive = StaticVerify::find_recursive_variable(
-      ContextStack::export_local_stack(), identifier.content);
-  if (recursive)
-    ErrorHandler::halt(ERecursiveVariable{identifier});
-
-  // any identifier will *always* have globbing enabled. if a replacement
-  // operator attempts to evaluate an ast object, it will override the globbing
-  // to false, but if the value it's referencing is behind another variable
-  // initialization, globbing should be enabled to avoid unintuitive errors.
-  EvaluationContext id_context = {context.task_scope, context.task_iteration,
-                                  true};
-
-  // check for any cached values.
-  for (ValueInstance &value : state->cached_variables) {
-    if (value.identifier == identifier &&
-        value.context.is_reachable_by(context)) {
-      return value.result->clone();
+Interpreter::evaluate_program(Program const &program,
+                              EvaluationContext context) {
+  return ProgramEvaluate{context, this->state}(program);
+}
+
+// returns true if waiting for the variable would, through other waiting
+// threads, eventually wait for the calling thread. must be called with the
+// cache locked.
+static bool is_cyclic_wait(EvaluationState &state, EvaluationKey key) {
+  std::thread::id self = std::this_thread::get_id();
+  for (size_t i = 0; i <= state.cached_variable_waits.size(); i++) {
+    auto cached_it = state.cached_variables.find(key);
+    if (cached_it == state.cached_variables.end())
+      return false;
+    std::thread::id evaluator = cached_it->second.evaluator;
+    if (evaluator == self)
+      return true;
+    auto wait_it = state.cached_variable_waits.find(evaluator);
+    if (wait_it == state.cached_variable_waits.end())
+      return false;
+    key = wait_it->second;
+  }
+  return true;
+}
+
+// evaluates a variable once, sharing the result with every other lookup.
+static std::unique_ptr<IValue>
+evaluate_cached(EvaluationState &state, EvaluationKey key,
+                std::function<std::unique_ptr<IValue>()> evaluate) {
+  std::unique_lock<std::mutex> guard(state.cached_variables_lock);
+  auto cached_it = state.cached_variables.find(key);
+  if (cached_it != state.cached_variables.end()) {
+    std::shared_future<std::shared_ptr<IValue>> value = cached_it->second.value;
+    bool ready = value.wait_for(std::chrono::seconds(0)) ==
+                 std::future_status::ready;
+    // a cyclic wait can only be caused by a recursive variable, which is
+    // reported once evaluated on this thread.
+    if (!ready && is_cyclic_wait(state, key)) {
+      guard.unlock();
+      return evaluate();
     }
+    std::thread::id self = std::this_thread::get_id();
+    if (!ready)
+      state.cached_variable_waits[self] = key;
+    guard.unlock();
+    std::shared_ptr<IValue> result = value.get();
+    if (!ready) {
+      guard.lock();
+      state.cached_variable_waits.erase(self);
+      guard.unlock();
+    }
+    return result ? result->clone() : evaluate();
   }
 
-  // task-specific fields.
+  std::promise<std::shared_ptr<IValue>> promise;
+  state.cached_variables[key] = {promise.get_future().share(),
+                                 std::this_thread::get_id()};
+  guard.unlock();
+
+  std::unique_ptr<IValue> result;
+  try {
+    result = evaluate();
+  } catch (...) {
+    // waiting threads evaluate the variable themselves.
+    promise.set_value(nullptr);
+    throw;
+  }
+  // values of a single iteration can be cached regardless of mutability.
+  bool cacheable = result->immutable || key.iteration;
+  promise.set_value(cacheable ? std::shared_ptr<IValue>(result->clone())
+                              : nullptr);
+  return result;
+}
+
+// evaluates a field on behalf of a task iteration once. values that do not
+// depend on the iteration are shared between every iteration of the task.
+static std::unique_ptr<IValue>
+evaluate_task_field(EvaluationState &state, size_t symbol,
+                    EvaluationContext context,
+                    std::function<std::unique_ptr<IValue>()> evaluate) {
+  size_t scope = context.task_scope->id;
+  if (!context.task_iteration)
+    return evaluate_cached(state, {symbol, scope, std::nullopt}, evaluate);
+  return evaluate_cached(state, {symbol, scope, std::nullopt}, [&]() {
+    return evaluate_cached(state, {symbol, scope, context.task_iteration},
+                           evaluate);
+  });
+}
+
+std::unique_ptr<IValue> ProgramEvaluate::load(Identifier const &identifier) {
+  FrameGuard frame{FrameKind::IdentifierEvaluate, identifier.content,
+                   identifier.reference};
+  // recursive variables have been ruled out by StaticVerify.
+
+  // task-specific fields. these shadow global fields, and are thus looked up
+  // first. globbing is *not* part of the key because fields are always
+  // compiled with globbing enabled, see the compiler.
   if (context.task_scope) {
-    auto local_it = this->context.task_scope->fields.find(identifier.content);
-    if (local_it != this->context.task_scope->fields.end()) {
-      ASTEvaluate ast_visitor = {id_context, state};
-      std::unique_ptr<IValue> result =
-          std::visit(ast_visitor, local_it->second.expression);
-      if (result->immutable)
-        state->cached_variables.push_back(
-            ValueInstance{identifier, id_context, std::move(result->clone())});
-      return result;
+    Task const &task = *context.task_scope;
+    // identifiers are bound to the slots of the task they appear in, but
+    // global fields may also be evaluated on behalf of a task.
+    size_t local_slot = identifier.local_slot;
+    bool is_iterator = identifier.is_iterator;
+    if (identifier.scope != task.id) {
+      local_slot = task.find_slot(identifier.symbol);
+      is_iterator = task.iterator.symbol == identifier.symbol;
+    }
+
+    if (local_slot != NO_SLOT) {
+      Program const &program = state->task_programs[task.id][local_slot];
+      return evaluate_task_field(*state, identifier.symbol, context, [&]() {
+        return ProgramEvaluate{context, state}(program);
+      });
     }
-  }
 
-  // task iteration variable - this isn't cached for obvious reasons.
-  if (context.task_iteration && context.task_scope)
-    if (context.task_scope->iterator.content == identifier.content)
-      return std::make_unique<IString>(*context.task_iteration,
-                                       context.task_scope->reference, MUTABLE);
+    // task iteration variable - this isn't cached for obvious reasons.
+    if (context.task_iteration && is_iterator)
+      return std::make_unique<IString>(*context.task_iteration, task.reference,
+                                       MUTABLE);
+  }
 
   // global fields.
-  auto global_it = this->state->ast->fields.find(identifier.content);
-  if (global_it != this->state->ast->fields.end()) {
-    ASTEvaluate ast_visitor = {EvaluationContext{std::nullopt, std::nullopt},
-                               state};
-    std::unique_ptr<IValue> result =
-        std::visit(ast_visitor, global_it->second.expression);
-    // allow globbing: see comment above.
-    EvaluationContext _context =
-        EvaluationContext{std::nullopt, std::nullopt, true};
-    if (result->immutable)
-      state->cached_variables.push_back(
-          ValueInstance{identifier, _context, std::move(result->clone())});
-    return result;
+  if (identifier.global_slot != NO_SLOT) {
+    Program const &program = state->global_programs[identifier.global_slot];
+    EvaluationKey key{identifier.symbol, GLOBAL_SCOPE, std::nullopt};
+    return evaluate_cached(*state, key, [&]() {
+      return ProgramEvaluate{{nullptr, std::nullopt}, state}(program);
+    });
   }
 
   ErrorHandler::halt(ENoMatchingIdentifier{identifier});
 }
 
-// note: we handle globbing **after** evaluating a formatted literal.
-std::unique_ptr<IValue> ASTEvaluate::operator()(Literal const &literal) {
-  return std::make_unique<IString>(literal.content, literal.reference,
-                                   IMMUTABLE);
-}
-
 // helper method: handles globbing.
 std::unique_ptr<IValue> expand_literal(IString input_istring) {
   size_t i_asterisk = input_istring.content.find('*');
@@ -263,29 +432,27 @@ std::unique_ptr<IValue> expand_literal(IString input_istring) {
     ErrorHandler::halt(EAdjacentWildcards{input_istring});
   }
 
-  // convert to interpreter strings.
-  std::vector<IString> contents;
-  for (const std::string &str : paths) {
-    contents.push_back(
-        IString{str, input_istring.reference, input_istring.immutable});
-  }
-
-  if (contents.size() == 1)
-    return std::make_unique<IString>(contents[0]);
-  return std::make_unique<IList<IString>>(contents, input_istring.reference,
-                                          input_istring.immutable);
+  if (paths.size() == 1)
+    return std::make_unique<IString>(paths[0], input_istring.reference,
+                                     input_istring.immutable);
+
+  // every path shares the reference of the literal.
+  std::unique_ptr<IList<IString>> ilist = std::make_unique<IList<IString>>(
+      std::vector<IString>{}, input_istring.reference, input_istring.immutable);
+  for (const std::string &str : paths)
+    ilist->contents.push_back(str, input_istring.reference,
+                              input_istring.immutable);
+  return ilist;
 }
 
-// note: if literal includes a `*`, globbing will be used - this is
-// expensive.
-std::unique_ptr<IValue>
-ASTEvaluate::operator()(FormattedLiteral const &formatted_literal) {
-  // IString out;
+// helper method: concatenates the parts of a formatted literal. globbing is
+// handled by a separate instruction.
+static std::unique_ptr<IValue>
+format_values(std::span<std::unique_ptr<IValue>> values,
+              StreamReference reference) {
   std::string out;
   bool immutable = true;
-  for (ASTObject const &ast_obj : formatted_literal.contents) {
-    ASTEvaluate ast_visitor = {context, state};
-    std::unique_ptr<IValue> obj_result = std::visit(ast_visitor, ast_obj);
+  for (std::unique_ptr<IValue> const &obj_result : values) {
     // append a string.
     if (obj_result->get_type() == IType::IString) {
       out += dynamic_cast<IString &>(*obj_result).content;
@@ -298,243 +465,371 @@ ASTEvaluate::operator()(FormattedLiteral const &formatted_literal) {
     }
     // append a list of strings.
     else if (obj_result->get_type() == IType::IList_IString) {
-      IList<IString> obj_result_list =
-          dynamic_cast<IList<IString> &>(*obj_result);
-      for (size_t i = 0; i < obj_result_list.contents.size(); i++) {
-        out += obj_result_list.contents[i].content;
+      StringColumn const &contents =
+          dynamic_cast<IList<IString> &>(*obj_result).contents;
+      for (size_t i = 0; i < contents.size(); i++) {
+        out += contents.view(i);
         immutable &= obj_result->immutable;
-        if (i < obj_result_list.contents.size() - 1)
+        if (i < contents.size() - 1)
           out += " ";
       }
     }
     // append a list of bools.
     else if (obj_result->get_type() == IType::IList_IBool) {
-      IList<IBool> obj_result_list = dynamic_cast<IList<IBool> &>(*obj_result);
-      for (size_t i = 0; i < obj_result_list.contents.size(); i++) {
-        out += obj_result_list.contents[i] ? "true" : "false";
+      SharedVector<IBool> const &contents =
+          dynamic_cast<IList<IBool> &>(*obj_result).contents;
+      for (size_t i = 0; i < contents.size(); i++) {
+        out += contents[i] ? "true" : "false";
         immutable &= obj_result->immutable;
-        if (i < obj_result_list.contents.size() - 1)
+        if (i < contents.size() - 1)
           out += " ";
       }
     }
   }
-
-  if (context.use_globbing)
-    return expand_literal(IString{out, formatted_literal.reference, immutable});
-  else
-    return std::make_unique<IString>(out, formatted_literal.reference,
-                                     immutable);
+  return std::make_unique<IString>(out, reference, immutable);
 }
 
-std::unique_ptr<IValue> ASTEvaluate::operator()(List const &list) {
-  assert(list.contents.size() > 0 && "attempt to evaluate empty list");
-
-  // the first element dictates the list type as lists only store one type.
-  ASTEvaluate ast_visitor = {context, state};
-  std::unique_ptr<IValue> first_value =
-      std::visit(ast_visitor, list.contents[0]);
-
-  if (first_value->get_type() == IType::IString) {
-    // evaluate list<string>
-    IList<IString> ilist{{}, list.reference, first_value->immutable};
-    ilist.contents.push_back(dynamic_cast<IString &>(*std::move(first_value)));
-
-    // evaluate the rest of the list
-    for (ASTObject const &ast_obj : list.contents | std::views::drop(1)) {
-      std::unique_ptr<IValue> value = std::visit(ast_visitor, ast_obj);
-      ilist.immutable &= value->immutable;
-      if (value->get_type() == IType::IString) {
-        ilist.contents.push_back(dynamic_cast<IString &>(*value));
-        continue;
-      } else if (value->get_type() == IType::IList_IString) {
-        std::vector<IString> value_contents =
-            dynamic_cast<IList<IString> &>(*value).contents;
-        ilist.contents.insert(ilist.contents.end(), value_contents.begin(),
-                              value_contents.end());
-        continue;
-      }
-      ErrorHandler::halt(EListTypeMismatch{ilist, *value});
-    }
-
-    return std::make_unique<IList<IString>>(ilist);
-
-  } else if (first_value->get_type() == IType::IBool) {
-    // evaluate list<bool>
-    IList<IBool> ilist{{}, list.reference, first_value->immutable};
-    ilist.contents.push_back(dynamic_cast<IBool &>(*first_value));
-
-    // evaluate the rest of the list
-    for (ASTObject const &ast_obj : list.contents | std::views::drop(1)) {
-      std::unique_ptr<IValue> value = std::visit(ast_visitor, ast_obj);
-      ilist.immutable &= value->immutable;
-      if (value->get_type() == IType::IBool) {
-        ilist.contents.push_back(dynamic_cast<IBool &>(*value));
-        continue;
-      } else if (value->get_type() == IType::IList_IBool) {
-        std::vector<IBool> value_contents =
-            dynamic_cast<IList<IBool> &>(*value).contents;
-        ilist.contents.insert(ilist.contents.end(), value_contents.begin(),
-                              value_contents.end());
-        continue;
-      }
-      ErrorHandler::halt(EListTypeMismatch{ilist, *value});
-    }
-
-    return std::make_unique<IList<IBool>>(ilist);
-
-  } else if (first_value->get_type() == IType::IList_IString) {
-    // evaluate list<string>
-    IList<IString> ilist{{}, list.reference, first_value->immutable};
-    std::vector<IString> first_value_contents =
-        dynamic_cast<IList<IString> &>(*first_value).contents;
-    ilist.contents.insert(ilist.contents.end(), first_value_contents.begin(),
-                          first_value_contents.end());
-
-    // evaluate the rest of the list
-    for (ASTObject const &ast_obj : list.contents | std::views::drop(1)) {
-      std::unique_ptr<IValue> value = std::visit(ast_visitor, ast_obj);
-      ilist.immutable &= value->immutable;
-      if (value->get_type() == IType::IString) {
-        ilist.contents.push_back(dynamic_cast<IString &>(*value));
-        continue;
-      } else if (value->get_type() == IType::IList_IString) {
-        std::vector<IString> value_contents =
-            dynamic_cast<IList<IString> &>(*value).contents;
-        ilist.contents.insert(ilist.contents.end(), value_contents.begin(),
-                              value_contents.end());
-        continue;
-      }
-      ErrorHandler::halt(EListTypeMismatch{ilist, *value});
+// helper method: collects the elements of a list of type T. lists are
+// flattened into the result.
+template <typename T>
+static std::unique_ptr<IValue>
+collect_list(std::span<std::unique_ptr<IValue>> values, IType element_type,
+             StreamReference reference) {
+  IList<T> ilist{{}, reference, values[0]->immutable};
+  for (std::unique_ptr<IValue> const &value : values) {
+    ilist.immutable &= value->immutable;
+    if (value->get_type() == element_type) {
+      ilist.contents.push_back(dynamic_cast<T &>(*value));
+      continue;
+    } else if (value->get_type() == ilist.get_type()) {
+      ilist.contents.append(dynamic_cast<IList<T> &>(*value).contents);
+      continue;
     }
+    ErrorHandler::halt(EListTypeMismatch{ilist, *value});
+  }
+  return std::make_unique<IList<T>>(std::move(ilist));
+}
 
-    return std::make_unique<IList<IString>>(ilist);
-
-  } else if (first_value->get_type() == IType::IList_IBool) {
-    // evaluate list<bool>
-    IList<IBool> ilist{{}, list.reference, first_value->immutable};
-    std::vector<IBool> first_value_contents =
-        dynamic_cast<IList<IBool> &>(*first_value).contents;
-    ilist.contents.insert(ilist.contents.end(), first_value_contents.begin(),
-                          first_value_contents.end());
-
-    // evaluate the rest of the list
-    for (ASTObject const &ast_obj : list.contents | std::views::drop(1)) {
-      std::unique_ptr<IValue> value = std::visit(ast_visitor, ast_obj);
-      ilist.immutable &= value->immutable;
-      if (value->get_type() == IType::IBool) {
-        ilist.contents.push_back(dynamic_cast<IBool &>(*value));
-        continue;
-      } else if (value->get_type() == IType::IList_IBool) {
-        std::vector<IBool> value_contents =
-            dynamic_cast<IList<IBool> &>(*value).contents;
-        ilist.contents.insert(ilist.contents.end(), value_contents.begin(),
-                              value_contents.end());
-        continue;
-      }
-      ErrorHandler::halt(EListTypeMismatch{ilist, *value});
-    }
+static std::unique_ptr<IValue>
+list_values(std::span<std::unique_ptr<IValue>> values,
+            StreamReference reference) {
+  assert(values.size() > 0 && "attempt to evaluate empty list");
 
-    return std::make_unique<IList<IBool>>(ilist);
-  }
+  // the first element dictates the list type as lists only store one type.
+  IType first_type = values[0]->get_type();
+  if (first_type == IType::IString || first_type == IType::IList_IString)
+    return collect_list<IString>(values, IType::IString, reference);
+  else if (first_type == IType::IBool || first_type == IType::IList_IBool)
+    return collect_list<IBool>(values, IType::IBool, reference);
 
   assert(false && "invalid list type");
 }
 
-std::unique_ptr<IValue> ASTEvaluate::operator()(Boolean const &boolean) {
-  return std::make_unique<IBool>(boolean.content, boolean.reference, true);
-}
-
-std::unique_ptr<IValue> ASTEvaluate::operator()(Replace const &replace) {
-  // override use_globbing to false since the wildcards need to be handled here.
-  EvaluationContext _context =
-      EvaluationContext{context.task_scope, context.task_iteration, false};
-  ASTEvaluate ast_visitor = {_context, state};
-  std::unique_ptr<IValue> input = std::visit(ast_visitor, *replace.input);
-  std::unique_ptr<IValue> filter = std::visit(ast_visitor, *replace.filter);
-  std::unique_ptr<IValue> product = std::visit(ast_visitor, *replace.product);
-
-  bool immutability =
-      input->immutable && filter->immutable && product->immutable;
+static std::unique_ptr<IValue> replace_values(Replace const &replace,
+                                              IValue &input, IValue &filter,
+                                              IValue &product) {
+  bool immutability = input.immutable && filter.immutable && product.immutable;
 
   // verify types.
-  if (filter->get_type() != IType::IString)
-    ErrorHandler::halt(EReplaceTypeMismatch{replace, *filter});
+  if (filter.get_type() != IType::IString)
+    ErrorHandler::halt(EReplaceTypeMismatch{replace, filter});
 
-  if (product->get_type() != IType::IString)
-    ErrorHandler::halt(EReplaceTypeMismatch{replace, *product});
+  if (product.get_type() != IType::IString)
+    ErrorHandler::halt(EReplaceTypeMismatch{replace, product});
 
   // fetch input.
-  IList<IString> input_parsed = input->autocast<IList<IString>>();
+  IList<IString> input_parsed = input.autocast<IList<IString>>();
   IList<IString> output_parsed{{}, replace.reference, immutability};
 
-  std::string filter_str = dynamic_cast<IString &>(*filter).content;
-  std::string product_str = dynamic_cast<IString &>(*product).content;
-
-  // convert to pure strings first...
-  std::vector<std::string> algorithm_input;
-  for (const IString &istring : input_parsed.contents) {
-    algorithm_input.push_back(istring.content);
-  }
-
-  std::vector<std::string> algorithm_output;
+  std::string const &filter_str = dynamic_cast<IString &>(filter).content;
+  std::string const &product_str = dynamic_cast<IString &>(product).content;
+  std::shared_ptr<ReplacePattern const> pattern;
   try {
-    algorithm_output =
-        Wildcards::compute_replace(algorithm_input, filter_str, product_str);
+    pattern = Wildcards::compile_replace(filter_str, product_str);
   } catch (LiteralsAdjacentWildcards &) {
-    ErrorHandler::halt(EAdjacentWildcards{dynamic_cast<IString &>(*filter)});
+    ErrorHandler::halt(EAdjacentWildcards{dynamic_cast<IString &>(filter)});
   } catch (LiteralsChunksLength &) {
-    ErrorHandler::halt(EReplaceChunksLength{*product});
+    ErrorHandler::halt(EReplaceChunksLength{product});
   }
 
-  // convert back to interpreter types for tracking
-  for (const std::string &str : algorithm_output) {
-    output_parsed.contents.push_back(
-        IString{str, replace.reference, immutability});
+  // elements are matched in place, and every product is written to the same
+  // buffer before being appended to the output.
+  StringColumn const &contents = input_parsed.contents;
+  std::vector<std::string_view> groups;
+  std::string buffer;
+  for (size_t i = 0; i < contents.size(); i++) {
+    std::string_view element = contents.view(i);
+    if (pattern->apply(element, groups, buffer))
+      element = buffer;
+    output_parsed.contents.push_back(element, replace.reference, immutability);
   }
 
   return std::make_unique<IList<IString>>(output_parsed);
 }
 
+std::unique_ptr<IValue> ProgramEvaluate::operator()(Program const &program) {
+  std::vector<std::unique_ptr<IValue>> &stack = evaluation_stack;
+  EvaluationStackGuard guard{stack.size()};
+
+  for (Instruction const &instruction : program.code) {
+    switch (instruction.opcode) {
+    case Opcode::Constant:
+      stack.push_back(program.constants[instruction.operand]->clone());
+      break;
+    case Opcode::Load:
+      stack.push_back(load(program.identifiers[instruction.operand]));
+      break;
+    case Opcode::Format:
+    case Opcode::List: {
+      auto first = stack.end() - instruction.operand;
+      std::span<std::unique_ptr<IValue>> values(first, stack.end());
+      std::unique_ptr<IValue> value =
+          instruction.opcode == Opcode::Format
+              ? format_values(values, instruction.reference)
+              : list_values(values, instruction.reference);
+      stack.erase(first, stack.end());
+      stack.push_back(std::move(value));
+      break;
+    }
+    case Opcode::Glob:
+      // note: if the string includes a `*`, globbing will be used - this is
+      // expensive.
+      stack.back() = expand_literal(dynamic_cast<IString &>(*stack.back()));
+      break;
+    case Opcode::Replace: {
+      auto first = stack.end() - 3;
+      std::unique_ptr<IValue> value =
+          replace_values(program.replaces[instruction.operand], *first[0],
+                         *first[1], *first[2]);
+      stack.erase(first, stack.end());
+      stack.push_back(std::move(value));
+      break;
+    }
+    }
+  }
+
+  assert(stack.size() == guard.base + 1 && "unbalanced program");
+  std::unique_ptr<IValue> result = std::move(stack.back());
+  stack.pop_back();
+  return result;
+}
+
 Interpreter::Interpreter(AST &ast, Setup &setup) {
   this->state = std::make_shared<EvaluationState>();
   this->state->ast = std::make_unique<AST>(ast);
   this->state->setup = setup;
+
+  // every expression is compiled once, ahead of evaluation.
+  for (Field const &field : this->state->ast->fields)
+    this->state->global_programs.push_back(
+        Compiler::compile(field.expression));
+  for (Task const &task : this->state->ast->tasks) {
+    std::vector<Program> &programs =
+        this->state->task_programs.emplace_back();
+    for (Field const &field : task.fields)
+      programs.push_back(Compiler::compile(field.expression));
+    this->state->identifier_programs.push_back(
+        Compiler::compile(task.identifier));
+  }
+}
+
+// collects patterns that every name a task identifier may evaluate to matches.
+// wildcards may be expanded by globbing or replacement operators, global
+// fields are followed, and anything else may evaluate to any name.
+static void collect_name_patterns(AST const &ast, ASTObject const &ast_object,
+                                  std::vector<TaskNamePattern> &patterns,
+                                  std::vector<size_t> &visiting) {
+  if (List const *list = std::get_if<List>(&ast_object)) {
+    for (ASTObject const &content : list->contents)
+      collect_name_patterns(ast, content, patterns, visiting);
+    return;
+  }
+  if (Replace const *replace = std::get_if<Replace>(&ast_object)) {
+    // elements that do not match the filter are passed through unchanged.
+    collect_name_patterns(ast, *replace->input, patterns, visiting);
+    collect_name_patterns(ast, *replace->product, patterns, visiting);
+    return;
+  }
+  // task identifiers are evaluated outside of any task, so identifiers can
+  // only refer to global fields. recursive fields are reported on evaluation.
+  Identifier const *identifier = std::get_if<Identifier>(&ast_object);
+  if (identifier && identifier->global_slot != NO_SLOT &&
+      std::ranges::find(visiting, identifier->global_slot) == visiting.end()) {
+    visiting.push_back(identifier->global_slot);
+    collect_name_patterns(ast, ast.fields[identifier->global_slot].expression,
+                          patterns, visiting);
+    visiting.pop_back();
+    return;
+  }
+
+  std::vector<ASTObject> contents;
+  if (FormattedLiteral const *formatted_literal =
+          std::get_if<FormattedLiteral>(&ast_object))
+    contents = formatted_literal->contents;
+  else if (std::holds_alternative<Literal>(ast_object))
+    contents = {ast_object};
+
+  // the literals surrounding the first and last non-literal part.
+  std::string leading, trailing;
+  size_t i_leading = 0;
+  for (; i_leading < contents.size(); i_leading++) {
+    Literal const *literal = std::get_if<Literal>(&contents[i_leading]);
+    if (!literal)
+      break;
+    leading += literal->content;
+  }
+  if (i_leading == contents.size() && !contents.empty()) {
+    // a literal only matches itself, or the paths it expands to.
+    size_t first_wildcard = leading.find('*');
+    if (first_wildcard == std::string::npos)
+      patterns.push_back({leading, ""});
+    else
+      patterns.push_back({leading.substr(0, first_wildcard),
+                          leading.substr(leading.rfind('*') + 1)});
+    return;
+  }
+  for (size_t i = contents.size(); i > i_leading; i--) {
+    Literal const *literal = std::get_if<Literal>(&contents[i - 1]);
+    if (!literal)
+      break;
+    trailing = literal->content + trailing;
+  }
+  size_t last_wildcard = trailing.rfind('*');
+  if (last_wildcard != std::string::npos)
+    trailing = trailing.substr(last_wildcard + 1);
+  patterns.push_back({leading.substr(0, leading.find('*')), trailing});
+}
+
+// names are matched by their normalised path, so patterns are normalised as
+// well. parts that may not survive normalisation unchanged are dropped, which
+// only makes the pattern less selective.
+static TaskNamePattern normalise_name_pattern(TaskNamePattern pattern) {
+  // a partial component starting with '.' may turn out to be "." or "..".
+  size_t i_slash = pattern.prefix.rfind('/');
+  std::string partial = i_slash == std::string::npos
+                            ? pattern.prefix
+                            : pattern.prefix.substr(i_slash + 1);
+  if (partial.starts_with('.'))
+    partial.clear();
+  std::string directory;
+  if (i_slash != std::string::npos) {
+    directory = Paths::normalise(pattern.prefix.substr(0, i_slash + 1));
+    if (directory == ".")
+      directory.clear();
+    else if (directory != "/")
+      directory += '/';
+  }
+  pattern.prefix = directory + partial;
+
+  if (pattern.suffix.ends_with('/') ||
+      pattern.suffix.find("//") != std::string::npos ||
+      pattern.suffix.find("/.") != std::string::npos)
+    pattern.suffix.clear();
+  return pattern;
 }
 
-std::optional<Task> Interpreter::find_task(std::string identifier) {
-  auto task_it = this->state->cached_tasks.find(identifier);
+static bool matches_name_patterns(std::vector<TaskNamePattern> const &patterns,
+                                  std::string const &name) {
+  for (TaskNamePattern const &pattern : patterns) {
+    if (name.size() >= pattern.prefix.size() + pattern.suffix.size() &&
+        name.starts_with(pattern.prefix) && name.ends_with(pattern.suffix))
+      return true;
+  }
+  return false;
+}
+
+// evaluates the identifier of a task and adds its names to the index. must be
+// called with the index locked.
+void Interpreter::index_task(Task const &task) {
+  std::unique_ptr<IValue> identifier = evaluate_program(
+      this->state->identifier_programs[task.id], {nullptr, std::nullopt});
+  IList<IString> identifiers = identifier->autocast<IList<IString>>();
+
+  for (size_t i = 0; i < identifiers.contents.size(); i++) {
+    std::string key(identifiers.contents.view(i));
+    PathId id = Paths::intern(key);
+    auto duplicate_it = this->state->cached_tasks.find(id);
+    if (duplicate_it != this->state->cached_tasks.end())
+      ErrorHandler::halt(
+          EDuplicateTask{*duplicate_it->second.task, task, key});
+    this->state->cached_tasks[id] = IndexedTask{&task, key};
+  }
+}
+
+// tasks are owned by the ast, which outlives every evaluation. names are
+// matched by their normalised path, and the name the task was declared with is
+// used as its iteration.
+IndexedTask const *Interpreter::find_task(std::string const &identifier) {
+  std::unique_lock<std::mutex> guard(this->state->cached_tasks_lock);
+  // every task that may be called this is indexed before the lookup, so that
+  // duplicate tasks are reported regardless of the order of lookups.
+  std::vector<PendingTask> &pending_tasks = this->state->pending_tasks;
+  PathId id = Paths::intern(identifier);
+  std::string const &normalised = Paths::resolve(id);
+  for (size_t i = 0; i < pending_tasks.size();) {
+    if (!matches_name_patterns(pending_tasks[i].patterns, normalised)) {
+      i++;
+      continue;
+    }
+    Task const &task = *pending_tasks[i].task;
+    pending_tasks.erase(pending_tasks.begin() + i);
+    index_task(task);
+  }
+
+  auto task_it = this->state->cached_tasks.find(id);
   if (task_it != this->state->cached_tasks.end())
-    return *task_it->second;
-  return std::nullopt;
+    return &task_it->second;
+  return nullptr;
 }
 
-std::optional<Field> Interpreter::find_field(std::string identifier,
-                                             std::optional<Task> task) {
+std::optional<FieldProgram>
+Interpreter::find_field_program(std::string const &identifier,
+                                Task const *task) {
+  // a field can only exist if its identifier appears in the config.
+  auto symbol_it = this->state->ast->symbols.find(identifier);
+  if (symbol_it == this->state->ast->symbols.end())
+    return std::nullopt;
+  size_t symbol = symbol_it->second;
+
   // task-specific fields.
   if (task) {
-    auto local_it = task->fields.find(identifier);
-    if (local_it != task->fields.end())
-      return local_it->second;
+    size_t local_slot = task->find_slot(symbol);
+    if (local_slot != NO_SLOT)
+      return FieldProgram{symbol,
+                          &this->state->task_programs[task->id][local_slot]};
   }
 
   // global fields.
-  auto global_it = this->state->ast->fields.find(identifier);
-  if (global_it != this->state->ast->fields.end())
-    return global_it->second;
+  size_t global_slot = this->state->ast->global_slots[symbol];
+  if (global_slot != NO_SLOT)
+    return FieldProgram{symbol, &this->state->global_programs[global_slot]};
 
   return std::nullopt;
 }
 
+// fields are evaluated on behalf of a task, and are thus memoised per task
+// iteration - even global ones, since they may refer to task fields.
+std::unique_ptr<IValue>
+Interpreter::evaluate_field_program(FieldProgram field,
+                                    EvaluationContext context) {
+  if (!context.task_scope)
+    return evaluate_program(*field.program, context);
+  return evaluate_task_field(*this->state, field.symbol, context, [&]() {
+    return evaluate_program(*field.program, context);
+  });
+}
+
 // if there is no default and field does not exist, return std::nullopt.
 // it is up to the caller to handle a missing mandatory field.
 std::optional<std::unique_ptr<IValue>> Interpreter::evaluate_field_default(
     std::string identifier, EvaluationContext context,
     std::optional<std::unique_ptr<IValue>> default_value) {
-  std::optional<Field> field = find_field(identifier, context.task_scope);
+  std::optional<FieldProgram> field =
+      find_field_program(identifier, context.task_scope);
   if (!field) {
     return default_value;
   }
-  return evaluate_ast_object(field->expression, context);
+  return evaluate_field_program(*field, context);
 }
 
 template <typename T>
@@ -555,10 +850,11 @@ Interpreter::evaluate_field_default_strict(std::string identifier,
 std::optional<std::unique_ptr<IValue>>
 Interpreter::evaluate_field_optional(std::string identifier,
                                      EvaluationContext context) {
-  std::optional<Field> field = find_field(identifier, context.task_scope);
+  std::optional<FieldProgram> field =
+      find_field_program(identifier, context.task_scope);
   if (!field)
     return std::nullopt;
-  return evaluate_ast_object(field->expression, context);
+  return evaluate_field_program(*field, context);
 }
 
 template <typename T>
@@ -573,252 +869,896 @@ Interpreter::evaluate_field_optional_strict(std::string identifier,
 }
 
 namespace PipelineJobs {
-class BuildJob : public PipelineJob {
+// runs bookkeeping that needs to happen at a certain point in the build graph,
+// e.g. marking a task as finished once all of its commands have completed.
+class CallbackJob : public PipelineJob {
 private:
-  std::function<void(RunContext)> function_ptr;
-  RunContext run_context;
+  std::function<void()> callback;
 
 public:
-  BuildJob(std::function<void(RunContext)> function_ptr, RunContext run_context)
-      : function_ptr(function_ptr) {
-    this->run_context = run_context;
-  }
+  CallbackJob(std::function<void()> callback) : callback(callback) {}
   void compute() noexcept {
     try {
-      ContextStack::import_local_stack(run_context.parent_frame_stack);
-      FrameGuard frame{DependencyBuildFrame(run_context.task_iteration,
-                                            run_context.task.reference)};
-      function_ptr(run_context);
+      callback();
     } catch (...) {
       this->report_error();
     }
   }
 };
+
+// the outcome of looking up a task iteration in the action cache.
+struct CachedAction {
+  uint64_t key = 0;
+  bool hit = false;
+};
+
+// a command that is skipped if its outputs were restored from the cache.
+class CachedCommandJob : public PipelineJob {
+private:
+  std::shared_ptr<PipelineJob> job;
+  std::shared_ptr<CachedAction> action;
+
+public:
+  CachedCommandJob(std::shared_ptr<PipelineJob> job,
+                   std::shared_ptr<CachedAction> action)
+      : job(job), action(action) {}
+  void compute() noexcept {
+    if (action->hit)
+      return;
+    job->compute();
+    if (job->had_error())
+      this->report_error();
+  }
+};
 } // namespace PipelineJobs
 
-size_t
+// fields are memoized, so the commands are only expanded once per build.
+uint64_t
+Interpreter::compute_command_fingerprint(Task const &task,
+                                         std::string const &task_iteration) {
+  std::optional<IList<IString>> command_expr =
+      evaluate_field_optional_strict<IList<IString>>(OPT_RUN,
+                                                     {&task, task_iteration});
+  IBool run_parallel_default = IBool(false, task.reference, IMMUTABLE);
+  IBool run_parallel = *evaluate_field_default_strict<IBool>(
+      OPT_RUN_PARALLEL, {&task, task_iteration}, run_parallel_default);
+  uint64_t command_fingerprint =
+      Hashing::hash_string(run_parallel ? "run_parallel" : "run");
+  if (command_expr) {
+    for (IString const &cmdline : command_expr->contents)
+      command_fingerprint = Hashing::combine(
+          command_fingerprint, Hashing::hash_string(cmdline.to_string()));
+  }
+  return command_fingerprint;
+}
+
+// task iterations that have not been built by us yet are only rebuilt once
+// they are planned themselves.
+bool Interpreter::has_changed_commands(Task const &task,
+                                       std::string const &task_iteration) {
+  std::optional<std::string> fingerprint =
+      this->state->commands.get(task_iteration);
+  return fingerprint &&
+         *fingerprint != BuildDatabase::pack({compute_command_fingerprint(
+                             task, task_iteration)});
+}
+
+// returns the latest change among the dependencies of a task iteration, where
+// FileTimestamp::max() indicates that it has no dependencies and thus always
+// needs to be rebuilt. the result is memoized for the rest of the build, so
+// that shared dependencies are only traversed once.
+DependencyChange Interpreter::compute_latest_task_change(
+    std::string task_iteration, std::optional<IList<IString>> dependencies) {
+  PathId id = Paths::intern(task_iteration);
+  std::unique_lock<std::mutex> guard(this->state->latest_changes_lock);
+  auto memo_it = this->state->latest_changes.find(id);
+  if (memo_it != this->state->latest_changes.end())
+    return memo_it->second;
+  guard.unlock();
+
+  DependencyChange latest_change =
+      dependencies ? compute_latest_dependency_change(*dependencies)
+                   : DependencyChange{FileTimestamp::max(), 0};
+  add_discovered_dependencies(task_iteration, latest_change);
+
+  guard.lock();
+  this->state->latest_changes[id] = latest_change;
+  return latest_change;
+}
+
+std::optional<DependencyChange>
+Interpreter::find_latest_task_change(std::string task_iteration) {
+  PathId id = Paths::intern(task_iteration);
+  std::unique_lock<std::mutex> guard(this->state->latest_changes_lock);
+  auto memo_it = this->state->latest_changes.find(id);
+  if (memo_it != this->state->latest_changes.end())
+    return memo_it->second;
+  return std::nullopt;
+}
+
+// the memoized change is only discarded once the task has been rebuilt.
+void Interpreter::invalidate_latest_task_change(std::string task_iteration) {
+  PathId id = Paths::intern(task_iteration);
+  std::unique_lock<std::mutex> guard(this->state->latest_changes_lock);
+  this->state->latest_changes.erase(id);
+}
+
+// when content hashing is enabled, the digest covers the names and contents
+// of every dependency, along with the digests of the tasks they refer to.
+DependencyChange
 Interpreter::compute_latest_dependency_change(IList<IString> dependencies) {
-  size_t latest_modification = 0;
+  bool content_hash = this->state->setup.content_hash;
+  DependencyChange latest_change{FileTimestamp::min(), 0};
   for (IString dependency : dependencies.contents) {
-    std::optional<Task> task = find_task(dependency.to_string());
-
-    std::optional<size_t> modified_i =
-        Filesystem::get_file_timestamp(dependency.to_string());
-    if (modified_i && latest_modification < modified_i)
-      latest_modification = *modified_i;
-    if (!task && modified_i) {
-      continue;
-    } else if (!task) {
+    PathId path = Paths::intern(dependency.to_string());
+    IndexedTask const *indexed = find_task(dependency.to_string());
+
+    std::optional<FileTimestamp> modified_i =
+        Filesystem::get_file_timestamp(path);
+    if (modified_i && latest_change.latest < *modified_i)
+      latest_change.latest = *modified_i;
+    if (!indexed && !modified_i) {
       // file does not exist, nor is there a task.
       ErrorHandler::halt(EDependencyFailed{dependency, dependency.to_string()});
     }
 
+    if (content_hash) {
+      latest_change.digest = Hashing::combine(
+          latest_change.digest, Hashing::hash_string(Paths::resolve(path)));
+      std::optional<uint64_t> hash_i =
+          Filesystem::get_file_hash(dependency.to_string());
+      if (hash_i)
+        latest_change.digest = Hashing::combine(latest_change.digest, *hash_i);
+    }
+
+    if (!indexed)
+      continue;
+    Task const *task = indexed->task;
+    std::string const &task_iteration = indexed->iteration;
+
     // context stack and recursion detection.
-    FrameGuard frame{
-        DependencyBuildFrame(dependency.to_string(), task->reference)};
-    // protects against unbound recursion.
-    bool recursive = StaticVerify::find_recursive_task(
-        ContextStack::export_local_stack(), dependency.to_string());
-    if (recursive) {
-      // this_entry_handle->set_status(CLIEntryStatus::Failed);
-      ErrorHandler::halt(ERecursiveTask{*task, dependency.to_string()});
+    FrameGuard frame{FrameKind::DependencyBuild, task_iteration,
+                     task->reference};
+    std::optional<DependencyChange> change_nested =
+        find_latest_task_change(task_iteration);
+    if (!change_nested) {
+      // protects against unbound recursion.
+      TaskRecursionGuard recursion{*task, task_iteration};
+
+      std::optional<IList<IString>> dependencies_nested =
+          evaluate_field_optional_strict<IList<IString>>(
+              OPT_DEPENDS, {task, task_iteration});
+      change_nested =
+          compute_latest_task_change(task_iteration, dependencies_nested);
     }
 
-    std::optional<IList<IString>> dependencies_nested =
-        evaluate_field_optional_strict<IList<IString>>(
-            OPT_DEPENDS, {task, dependency.to_string()});
-    if (dependencies_nested) {
-      size_t modification_nested =
-          compute_latest_dependency_change(*dependencies_nested);
-      if (latest_modification < modification_nested)
-        latest_modification = modification_nested;
-    } else if (task) {
-      // task exists but doesn't have any dependencies.
-      return SIZE_MAX;
+    // a dependency whose commands have changed is rebuilt, and so is
+    // anything that depends on it.
+    FileTimestamp latest_nested = change_nested->latest;
+    if (has_changed_commands(*task, task_iteration))
+      latest_nested = FileTimestamp::max();
+
+    // nothing can be more recent than this, but the digest still has to
+    // cover the remaining dependencies.
+    if (latest_nested == FileTimestamp::max() && !content_hash)
+      return DependencyChange{FileTimestamp::max(), 0};
+    if (latest_change.latest < latest_nested)
+      latest_change.latest = latest_nested;
+    if (content_hash)
+      latest_change.digest =
+          Hashing::combine(latest_change.digest, change_nested->digest);
+  }
+  return latest_change;
+}
+
+// folds in the dependencies that were discovered through the depfile of a
+// task iteration the last time it was built.
+void Interpreter::add_discovered_dependencies(std::string task_iteration,
+                                              DependencyChange &change) {
+  bool content_hash = this->state->setup.content_hash;
+  if (change.latest == FileTimestamp::max() && !content_hash)
+    return;
+  std::optional<std::string> discovered =
+      this->state->discovered_dependencies.get(task_iteration);
+  if (!discovered)
+    return;
+
+  for (std::string const &dependency :
+       BuildDatabase::unpack_strings(*discovered)) {
+    std::optional<FileTimestamp> modified =
+        Filesystem::get_file_timestamp(dependency);
+    if (!modified) {
+      // e.g. a header was removed; the compiler needs to decide what happens.
+      change.latest = FileTimestamp::max();
+      if (!content_hash)
+        return;
+    } else if (change.latest < *modified) {
+      change.latest = *modified;
+    }
+    if (content_hash) {
+      change.digest = Hashing::combine(change.digest,
+                                       Hashing::hash_string(dependency));
+      std::optional<uint64_t> hash = Filesystem::get_file_hash(dependency);
+      if (hash)
+        change.digest = Hashing::combine(change.digest, *hash);
     }
   }
-  return latest_modification;
 }
 
-void Interpreter::solve_dependencies(
-    IList<IString> dependencies,
-    std::shared_ptr<CLIEntryHandle> parent_iteration, bool parallel) {
-  auto topography = parallel ? PipelineSchedulingTopography::Parallel
-                             : PipelineSchedulingTopography::Sequential;
-  auto scheduler =
-      PipelineScheduler<PipelineSchedulingMethod::Unbound>(topography);
+// records the dependencies listed in the depfile of a task iteration that has
+// just been built. they are only used on subsequent builds.
+void Interpreter::ingest_depfile(std::string task_iteration,
+                                 std::optional<std::string> depfile) {
+  std::optional<std::vector<std::string>> discovered =
+      depfile ? Depfile::parse(*depfile) : std::nullopt;
+  if (!discovered) {
+    this->state->discovered_dependencies.erase(task_iteration);
+    return;
+  }
+  this->state->discovered_dependencies.put(
+      task_iteration, BuildDatabase::pack_strings(*discovered));
+}
+
+// resolves the program invoked by a command line through $PATH, so that
+// upgrading e.g. the compiler invalidates cached outputs.
+static std::optional<std::string> find_program(std::string const &cmdline) {
+  size_t begin = cmdline.find_first_not_of(" \t");
+  if (begin == std::string::npos)
+    return std::nullopt;
+  size_t end = cmdline.find_first_of(" \t", begin);
+  std::string program = cmdline.substr(begin, end - begin);
+  if (program.find('/') != std::string::npos)
+    return program;
 
+  char const *path = std::getenv("PATH");
+  if (!path)
+    return std::nullopt;
+  std::string directories = path;
+  size_t offset = 0;
+  while (offset <= directories.size()) {
+    size_t separator = directories.find(':', offset);
+    if (separator == std::string::npos)
+      separator = directories.size();
+    std::string candidate =
+        directories.substr(offset, separator - offset) + "/" + program;
+    std::optional<FileStatus> status = Filesystem::get_file_status(candidate);
+    if (status && status->regular)
+      return candidate;
+    offset = separator + 1;
+  }
+  return std::nullopt;
+}
+
+// identifies an execution of a task iteration by its commands, the programs
+// they invoke, and the contents of its declared dependencies. the dependency
+// digest covers the tasks below them, which abstract tasks have no contents
+// of their own to stand in for. inputs that are discovered through depfiles
+// are matched by the cache itself.
+uint64_t Interpreter::compute_action_key(
+    IList<IString> dependencies, IList<IString> commands,
+    uint64_t command_fingerprint, uint64_t dependency_digest,
+    std::vector<std::string> const &outputs) {
+  uint64_t key = Hashing::combine(command_fingerprint, dependency_digest);
+  for (std::string const &output : outputs)
+    key = Hashing::combine(key, Hashing::hash_string(output));
+  for (IString const &cmdline : commands.contents) {
+    std::optional<std::string> program = find_program(cmdline.to_string());
+    std::optional<uint64_t> program_hash =
+        program ? Filesystem::get_file_hash(*program) : std::nullopt;
+    if (program_hash)
+      key = Hashing::combine(key, *program_hash);
+  }
+  for (IString const &dependency : dependencies.contents) {
+    key = Hashing::combine(key, Hashing::hash_string(dependency.to_string()));
+    std::optional<uint64_t> hash =
+        Filesystem::get_file_hash(dependency.to_string());
+    if (hash)
+      key = Hashing::combine(key, *hash);
+  }
+  return key;
+}
+
+// a task is up to date if its output exists, its commands are the same as
+// when it was last built, and no dependency has changed since.
+bool Interpreter::is_up_to_date(std::string task_iteration,
+                                DependencyChange change,
+                                uint64_t command_fingerprint) {
+  if (change.latest == FileTimestamp::max())
+    return false;
+  std::optional<FileTimestamp> latest_this_change =
+      Filesystem::get_file_timestamp(task_iteration);
+  if (!latest_this_change)
+    return false;
+  // outputs without a recorded fingerprint were not built by us, or were
+  // built by an earlier version; either way their commands are unknown.
+  std::optional<std::string> fingerprint =
+      this->state->commands.get(task_iteration);
+  if (!fingerprint ||
+      *fingerprint != BuildDatabase::pack({command_fingerprint}))
+    return false;
+  if (!this->state->setup.content_hash)
+    return *latest_this_change >= change.latest;
+
+  // file timestamps are disregarded, as e.g. switching branches touches files
+  // without necessarily changing their contents.
+  std::optional<std::string> digest = this->state->digests.get(task_iteration);
+  return digest && *digest == BuildDatabase::pack({change.digest});
+}
+
+// evaluates whether parallel dependencies are up to date concurrently, so that
+// planning them afterwards only needs to consult the memoized results.
+void Interpreter::prefetch_dependencies(BuildPlan &plan,
+                                        IList<IString> dependencies) {
+  PipelineScheduler<PipelineSchedulingMethod::Managed> scheduler(
+      PipelineSchedulingTopography::Parallel);
+  // the parent frames refer to names that outlive the prefetch.
+  std::vector<FrameRecord> parent_stack = ContextStack::export_local_stack();
+  std::vector<PathId> parent_tasks = TaskRecursionGuard::export_local_tasks();
+  size_t scheduled = 0;
   for (IString dependency : dependencies.contents) {
-    std::optional<Task> task = find_task(dependency.to_string());
-    if (!task) {
+    IndexedTask const *indexed = find_task(dependency.to_string());
+    if (!indexed || plan.planned.contains(Paths::intern(indexed->iteration)) ||
+        find_latest_task_change(indexed->iteration))
       continue;
-    }
-    scheduler.schedule_job(std::make_shared<PipelineJobs::BuildJob>(
-        [this](RunContext x) { return this->run_task(x); },
-        RunContext{*task, dependency.to_string(), parent_iteration,
-                   ContextStack::export_local_stack()}));
+    Task const *task = indexed->task;
+    std::string task_iteration = indexed->iteration;
+    scheduler.schedule_job(std::make_shared<PipelineJobs::CallbackJob>(
+        [this, task, task_iteration, parent_stack, parent_tasks]() {
+          ContextStack::import_local_stack(parent_stack);
+          TaskRecursionGuard::import_local_tasks(parent_tasks);
+          try {
+            FrameGuard frame{FrameKind::DependencyBuild, task_iteration,
+                             task->reference};
+            TaskRecursionGuard recursion{*task, task_iteration};
+            std::optional<IList<IString>> dependencies_nested =
+                evaluate_field_optional_strict<IList<IString>>(
+                    OPT_DEPENDS, {task, task_iteration});
+            if (dependencies_nested)
+              compute_latest_task_change(task_iteration, dependencies_nested);
+          } catch (...) {
+            // errors have published the stack already, and the thread is
+            // reused by other jobs.
+            ContextStack::import_local_stack({});
+            TaskRecursionGuard::import_local_tasks({});
+            throw;
+          }
+          ContextStack::import_local_stack({});
+          TaskRecursionGuard::import_local_tasks({});
+        }));
+    scheduled++;
   }
+  if (scheduled < 2)
+    return; // nothing to be gained.
 
   scheduler.send_and_await();
   if (scheduler.had_errors())
     ErrorHandler::trigger_report();
 }
 
-void Interpreter::run_task(RunContext run_context) {
-  Task task = run_context.task;
-  std::string task_iteration = run_context.task_iteration;
-  std::optional<std::shared_ptr<CLIEntryHandle>> parent_iteration =
-      run_context.parent_handle;
+// plans every task in the dependency list. sequential dependencies are
+// chained using the barrier, so that no job in the subtree of a dependency is
+// started before the previous dependency has been built.
+std::vector<size_t> Interpreter::plan_dependencies(
+    BuildPlan &plan, IList<IString> dependencies,
+    std::shared_ptr<CLIEntryHandle> handle, bool parallel,
+    std::vector<size_t> barrier) {
+  if (parallel)
+    prefetch_dependencies(plan, dependencies);
 
-  // check for recursive dependencies.
-  bool recursive = StaticVerify::find_recursive_task(
-      ContextStack::export_local_stack(), task_iteration);
-  if (recursive) {
-    // this_entry_handle->set_status(CLIEntryStatus::Failed);
-    ErrorHandler::halt(ERecursiveTask{task, task_iteration});
+  std::vector<size_t> built_vertices;
+  std::vector<size_t> dependency_barrier = barrier;
+
+  for (IString dependency : dependencies.contents) {
+    IndexedTask const *indexed = find_task(dependency.to_string());
+    if (!indexed)
+      continue;
+
+    bool previously_planned =
+        plan.planned.contains(Paths::intern(indexed->iteration));
+    FrameGuard frame{FrameKind::DependencyBuild, indexed->iteration,
+                     indexed->task->reference};
+    std::optional<size_t> built_vertex =
+        plan_task(plan, *indexed->task, indexed->iteration, handle,
+                  dependency_barrier);
+    if (!built_vertex)
+      continue;
+    built_vertices.push_back(*built_vertex);
+
+    if (parallel)
+      continue;
+    // a newly planned task already waits for the entire barrier, but a task
+    // that was planned elsewhere does not.
+    if (previously_planned)
+      dependency_barrier.push_back(*built_vertex);
+    else
+      dependency_barrier = {*built_vertex};
   }
 
-  std::shared_ptr<CLIEntryHandle> this_entry_handle;
+  return built_vertices;
+}
+
+// evaluates a task iteration along with its dependencies and adds the jobs
+// required to build it to the plan. returns the vertex that signals that the
+// task has been built, or std::nullopt if it is already up to date.
+std::optional<size_t> Interpreter::plan_task(
+    BuildPlan &plan, Task const &task, std::string task_iteration,
+    std::optional<std::shared_ptr<CLIEntryHandle>> parent_handle,
+    std::vector<size_t> barrier) {
+  // tasks that are depended upon more than once are only built once.
+  PathId id = Paths::intern(task_iteration);
+  auto planned_it = plan.planned.find(id);
+  if (planned_it != plan.planned.end())
+    return planned_it->second;
+
+  // check for recursive dependencies.
+  TaskRecursionGuard recursion{task, task_iteration};
 
   std::optional<IList<IString>> dependencies =
       evaluate_field_optional_strict<IList<IString>>(OPT_DEPENDS,
-                                                     {task, task_iteration});
+                                                     {&task, task_iteration});
+
+  // commands are evaluated up front, as changing them invalidates the task.
+  std::optional<IList<IString>> command_expr =
+      evaluate_field_optional_strict<IList<IString>>(OPT_RUN,
+                                                     {&task, task_iteration});
+  IBool run_parallel_default = IBool(false, task.reference, IMMUTABLE);
+  IBool run_parallel = *evaluate_field_default_strict<IBool>(
+      OPT_RUN_PARALLEL, {&task, task_iteration}, run_parallel_default);
+  uint64_t command_fingerprint =
+      compute_command_fingerprint(task, task_iteration);
+
+  std::optional<IString> depfile_expr =
+      evaluate_field_optional_strict<IString>(OPT_DEPFILE,
+                                              {&task, task_iteration});
+  std::optional<std::string> depfile;
+  if (depfile_expr)
+    depfile = depfile_expr->to_string();
 
   // check for cached dependencies.
-  bool dependency_build_required = false;
   if (dependencies) {
-    size_t latest_dependency_change =
-        compute_latest_dependency_change(*dependencies);
-    std::optional<size_t> latest_this_change =
-        Filesystem::get_file_timestamp(task_iteration);
-    if (latest_this_change && *latest_this_change >= latest_dependency_change) {
+    DependencyChange latest_dependency_change =
+        compute_latest_task_change(task_iteration, dependencies);
+    if (is_up_to_date(task_iteration, latest_dependency_change,
+                      command_fingerprint)) {
       CLI::increment_skipped_tasks();
-      return;
+      plan.planned[id] = std::nullopt;
+      return std::nullopt;
     }
-    // task needs to be rebuilt.
-    dependency_build_required = true;
   }
 
   // handle is generated here because we know for a fact that the task will need
   // to be rebuilt - we have already checked that it isn't cached.
+  std::shared_ptr<CLIEntryHandle> this_entry_handle;
   std::optional<IBool> visible = evaluate_field_default_strict<IBool>(
-      OPT_VISIBLE, {task, task_iteration},
+      OPT_VISIBLE, {&task, task_iteration},
       IBool(true, task.reference, IMMUTABLE));
-  if (parent_iteration) {
-    this_entry_handle =
-        CLI::derive_entry_from(*run_context.parent_handle, task_iteration,
-                               CLIEntryStatus::Scheduled, *visible);
+  if (parent_handle) {
+    this_entry_handle = CLI::derive_entry_from(
+        *parent_handle, task_iteration, CLIEntryStatus::Scheduled, *visible);
   } else {
     this_entry_handle = CLI::generate_entry(
         task_iteration, CLIEntryStatus::Scheduled, *visible);
     this_entry_handle->set_highlighted(true);
   }
 
-  if (dependency_build_required) {
+  // the task can start once its dependencies and the barrier have been built.
+  std::vector<size_t> start_vertices = barrier;
+  if (dependencies) {
     IBool parallel_default = IBool(false, task.reference, IMMUTABLE);
     // it is safe to unwrap the std::optional because we have a default value.
     IBool parallel = *evaluate_field_default_strict<IBool>(
-        OPT_DEPENDS_PARALLEL, {task, task_iteration}, parallel_default);
-    solve_dependencies(*dependencies, this_entry_handle, parallel);
+        OPT_DEPENDS_PARALLEL, {&task, task_iteration}, parallel_default);
+    std::vector<size_t> dependency_vertices = plan_dependencies(
+        plan, *dependencies, this_entry_handle, parallel, barrier);
+    start_vertices.insert(start_vertices.end(), dependency_vertices.begin(),
+                          dependency_vertices.end());
+  }
+
+  BuildNode node{task_iteration, this_entry_handle, {}};
+
+  // the outputs of tasks with declared dependencies may be restored from the
+  // action cache, in which case their commands are skipped.
+  ActionCache *action_cache = this->state->action_cache.get();
+  std::shared_ptr<PipelineJobs::CachedAction> cached_action;
+  std::vector<std::string> outputs = {task_iteration};
+  if (depfile)
+    outputs.push_back(*depfile);
+  if (action_cache && dependencies && command_expr) {
+    cached_action = std::make_shared<PipelineJobs::CachedAction>();
+    std::shared_ptr<PipelineJob> lookup_job =
+        std::make_shared<PipelineJobs::CallbackJob>(
+            [this, action_cache, cached_action, task_iteration,
+             dependencies, command_expr, command_fingerprint, outputs]() {
+              // the change memoized while planning predates the dependencies
+              // that have been rebuilt since.
+              this->invalidate_latest_task_change(task_iteration);
+              DependencyChange change =
+                  this->compute_latest_task_change(task_iteration,
+                                                   dependencies);
+              cached_action->key = this->compute_action_key(
+                  *dependencies, *command_expr, command_fingerprint,
+                  change.digest, outputs);
+              cached_action->hit =
+                  action_cache->restore(cached_action->key, outputs);
+              if (cached_action->hit)
+                return;
+              // restored outputs share their contents with the cache, or
+              // are read-only copies of it once the blob has been evicted,
+              // so they must not be written to in place.
+              for (std::string const &output : outputs) {
+                std::error_code error;
+                std::filesystem::perms perms =
+                    std::filesystem::status(output, error).permissions();
+                if (error)
+                  continue;
+                if ((perms & std::filesystem::perms::owner_write) ==
+                        std::filesystem::perms::none ||
+                    std::filesystem::hard_link_count(output, error) > 1)
+                  std::filesystem::remove(output, error);
+              }
+            });
+    node.jobs.push_back(lookup_job);
+    start_vertices = {plan.graph.add_job(lookup_job, start_vertices)};
   }
 
+  std::vector<size_t> finish_vertices = start_vertices;
+
   // execution related fields.
-  std::optional<IList<IString>> command_expr =
-      evaluate_field_optional_strict<IList<IString>>(OPT_RUN,
-                                                     {task, task_iteration});
-  if (!command_expr) {
-    this_entry_handle->set_status(CLIEntryStatus::Finished);
-    return; // abstract task.
+  if (command_expr) {
+    IBool silent_default = IBool(false, task.reference, IMMUTABLE);
+    IBool silent = *evaluate_field_default_strict<IBool>(
+        OPT_SILENT, {&task, task_iteration}, silent_default);
+
+    IBool cli_default = IBool(true, task.reference, IMMUTABLE);
+    IBool cli = *evaluate_field_default_strict<IBool>(
+        OPT_CLI, {&task, task_iteration}, cli_default);
+
+    ExecutionOptions exec_options = {cli, silent};
+
+    finish_vertices.clear();
+    for (IString cmdline : command_expr->contents) {
+      std::shared_ptr<PipelineJob> job;
+      if (this->state->setup.dry_run) {
+        // commands should still be sent to stdout.
+        std::string cmdline_str = cmdline.to_string();
+        job = std::make_shared<PipelineJobs::CallbackJob>(
+            [cmdline_str]() { CLI::write_standard(cmdline_str + "\n"); });
+      } else {
+        job = std::make_shared<PipelineJobs::ExecuteJob>(
+            cmdline.to_string(), cmdline.reference, this_entry_handle,
+            exec_options, task_iteration);
+      }
+      if (cached_action)
+        job = std::make_shared<PipelineJobs::CachedCommandJob>(job,
+                                                               cached_action);
+      node.jobs.push_back(job);
+      size_t vertex = plan.graph.add_job(job, start_vertices);
+      finish_vertices.push_back(vertex);
+      // sequential commands wait for the previous command.
+      if (!run_parallel)
+        start_vertices = {vertex};
+    }
   }
-  IBool run_parallel_default = IBool(false, task.reference, IMMUTABLE);
-  IBool run_parallel = *evaluate_field_default_strict<IBool>(
-      OPT_RUN_PARALLEL, {task, task_iteration}, run_parallel_default);
 
-  IBool silent_default = IBool(false, task.reference, IMMUTABLE);
-  IBool silent = *evaluate_field_default_strict<IBool>(
-      OPT_SILENT, {task, task_iteration}, silent_default);
+  bool dry_run = this->state->setup.dry_run;
+  size_t built_vertex = plan.graph.add_job(
+      std::make_shared<PipelineJobs::CallbackJob>([this, this_entry_handle,
+                                                   task_iteration, dependencies,
+                                                   command_fingerprint,
+                                                   depfile, dry_run,
+                                                   action_cache, cached_action,
+                                                   outputs]() {
+        if (dry_run)
+          return;
+        this->ingest_depfile(task_iteration, depfile);
+        if (cached_action && !cached_action->hit) {
+          // commands without an output, e.g. phony tasks, are not cached.
+          bool produced_outputs = true;
+          for (std::string const &output : outputs) {
+            std::error_code error;
+            produced_outputs &=
+                std::filesystem::is_regular_file(output, error);
+          }
+          std::optional<std::string> discovered =
+              this->state->discovered_dependencies.get(task_iteration);
+          if (produced_outputs)
+            action_cache->store(
+                cached_action->key,
+                discovered ? BuildDatabase::unpack_strings(*discovered)
+                           : std::vector<std::string>{},
+                outputs);
+        }
+        this->invalidate_latest_task_change(task_iteration);
+        this->state->commands.put(task_iteration,
+                                  BuildDatabase::pack({command_fingerprint}));
+        // the digest is recomputed as dependencies may have been rebuilt.
+        if (this->state->setup.content_hash && dependencies) {
+          DependencyChange change =
+              this->compute_latest_task_change(task_iteration, dependencies);
+          this->state->digests.put(task_iteration,
+                                   BuildDatabase::pack({change.digest}));
+        }
+        this_entry_handle->set_status(CLIEntryStatus::Finished);
+      }),
+      finish_vertices);
+
+  plan.nodes.push_back(node);
+  plan.planned[id] = built_vertex;
+  return built_vertex;
+}
 
-  IBool cli_default = IBool(true, task.reference, IMMUTABLE);
-  IBool cli = *evaluate_field_default_strict<IBool>(
-      OPT_CLI, {task, task_iteration}, cli_default);
+// returns the string an expression evaluates to, if it consists of literals.
+static std::optional<std::string>
+find_constant_string(ASTObject const &ast_object) {
+  if (Literal const *literal = std::get_if<Literal>(&ast_object))
+    return literal->content;
+  FormattedLiteral const *formatted_literal =
+      std::get_if<FormattedLiteral>(&ast_object);
+  if (!formatted_literal)
+    return std::nullopt;
+  std::string constant;
+  for (ASTObject const &content : formatted_literal->contents) {
+    Literal const *literal = std::get_if<Literal>(&content);
+    if (!literal)
+      return std::nullopt;
+    constant += literal->content;
+  }
+  return constant;
+}
 
-  ExecutionOptions exec_options = {cli, silent};
+static GlobalFieldInfo const &
+analyse_global_field(AST const &ast, size_t slot,
+                     std::vector<std::optional<GlobalFieldInfo>> &infos);
+
+// returns whether a glob has adjacent wildcards within a path segment, which
+// cannot be parsed. a segment that consists of `**` alone is recursive.
+static bool has_adjacent_wildcards(std::string_view glob) {
+  for (size_t i_segment = 0; i_segment <= glob.size();) {
+    size_t i_end = glob.find('/', i_segment);
+    if (i_end == std::string_view::npos)
+      i_end = glob.size();
+    std::string_view segment = glob.substr(i_segment, i_end - i_segment);
+    if (segment != "**" && segment.find("**") != std::string_view::npos)
+      return true;
+    i_segment = i_end + 1;
+  }
+  return false;
+}
 
-  // execute task.
-  if (this->state->setup.dry_run) {
-    // commands should still be sent to stdout.
-    for (IString cmdline : command_expr->contents)
-      CLI::write_standard(cmdline.to_string() + "\n");
+// conservatively decides whether an expression can raise an error. anything
+// that may evaluate to a bool is treated as fallible, so that every value
+// involved is a string or a list of strings.
+static void
+analyse_expression(AST const &ast, ASTObject const &ast_object,
+                   bool use_globbing, GlobalFieldInfo &info,
+                   std::vector<std::optional<GlobalFieldInfo>> &infos) {
+  if (std::holds_alternative<Literal>(ast_object))
+    return;
+  if (std::holds_alternative<Boolean>(ast_object)) {
+    info.infallible = false;
     return;
   }
 
-  auto topography = run_parallel ? PipelineSchedulingTopography::Parallel
-                                 : PipelineSchedulingTopography::Sequential;
-  auto scheduler =
-      PipelineScheduler<PipelineSchedulingMethod::Managed>(topography);
+  if (Identifier const *identifier = std::get_if<Identifier>(&ast_object)) {
+    if (identifier->global_slot == NO_SLOT) {
+      info.infallible = false;
+      return;
+    }
+    info.references.push_back(identifier->global_slot);
+    GlobalFieldInfo const &referenced =
+        analyse_global_field(ast, identifier->global_slot, infos);
+    info.infallible &= referenced.infallible;
+    info.globs |= referenced.globs;
+    return;
+  }
 
-  for (IString cmdline : command_expr->contents) {
-    scheduler.schedule_job(std::make_shared<PipelineJobs::ExecuteJob>(
-        cmdline.to_string(), cmdline.reference, this_entry_handle,
-        exec_options));
+  if (List const *list = std::get_if<List>(&ast_object)) {
+    for (ASTObject const &content : list->contents)
+      analyse_expression(ast, content, use_globbing, info, infos);
+    return;
   }
-  scheduler.send_and_await();
 
-  if (scheduler.had_errors()) {
-    this_entry_handle->set_status(CLIEntryStatus::Failed);
-    ErrorHandler::trigger_report();
+  if (FormattedLiteral const *formatted_literal =
+          std::get_if<FormattedLiteral>(&ast_object)) {
+    std::optional<std::string> constant = find_constant_string(ast_object);
+    if (!constant) {
+      for (ASTObject const &content : formatted_literal->contents)
+        analyse_expression(ast, content, use_globbing, info, infos);
+      // the pattern is only known once evaluated.
+      if (use_globbing)
+        info.infallible = false;
+      return;
+    }
+    if (use_globbing && constant->find('*') != std::string::npos) {
+      info.globs = true;
+      info.infallible &= !has_adjacent_wildcards(*constant);
+    }
+    return;
+  }
+
+  Replace const &replace = std::get<Replace>(ast_object);
+  analyse_expression(ast, *replace.input, false, info, infos);
+  std::optional<std::string> filter = find_constant_string(*replace.filter);
+  std::optional<std::string> product = find_constant_string(*replace.product);
+  if (!filter || !product || filter->find("**") != std::string::npos ||
+      std::ranges::count(*product, '*') > std::ranges::count(*filter, '*'))
+    info.infallible = false;
+}
+
+static GlobalFieldInfo const &
+analyse_global_field(AST const &ast, size_t slot,
+                     std::vector<std::optional<GlobalFieldInfo>> &infos) {
+  if (infos[slot])
+    return *infos[slot];
+  // recursive fields see themselves as fallible.
+  infos[slot] = GlobalFieldInfo{false, false, {}};
+  GlobalFieldInfo info;
+  analyse_expression(ast, ast.fields[slot].expression, true, info, infos);
+  infos[slot] = info;
+  return *infos[slot];
+}
+
+// evaluates global fields that expand globs ahead of the build, in parallel.
+// only fields that cannot raise an error are considered, so that errors are
+// still reported in the context the field is used in.
+void Interpreter::preevaluate_globals() {
+  AST const &ast = *this->state->ast;
+  std::vector<std::optional<GlobalFieldInfo>> infos(ast.fields.size());
+  // global slot -> graph vertex evaluating the field.
+  std::vector<std::optional<size_t>> vertices(ast.fields.size());
+  PipelineGraph graph;
+  size_t scheduled = 0;
+
+  // fields are added after the fields they refer to, which they depend on.
+  std::function<void(size_t)> add_field = [&](size_t slot) {
+    GlobalFieldInfo const &info = analyse_global_field(ast, slot, infos);
+    if (vertices[slot] || !info.infallible || !info.globs)
+      return;
+    std::vector<size_t> dependencies;
+    for (size_t reference : info.references) {
+      add_field(reference);
+      if (vertices[reference] &&
+          std::ranges::find(dependencies, *vertices[reference]) ==
+              dependencies.end())
+        dependencies.push_back(*vertices[reference]);
+    }
+
+    EvaluationKey key{ast.fields[slot].identifier.symbol, GLOBAL_SCOPE,
+                      std::nullopt};
+    Program const &program = this->state->global_programs[slot];
+    vertices[slot] = graph.add_job(
+        std::make_shared<PipelineJobs::CallbackJob>([this, key, &program]() {
+          evaluate_cached(*this->state, key, [&]() {
+            return ProgramEvaluate{{nullptr, std::nullopt},
+                                   this->state}(program);
+          });
+        }),
+        dependencies);
+    scheduled++;
+  };
+  for (size_t slot = 0; slot < ast.fields.size(); slot++)
+    add_field(slot);
+
+  // failed fields are evaluated again once used, which reports the error.
+  graph.send_and_await();
+  CLI::write_verbose("evaluated " + std::to_string(scheduled) +
+                     " global fields ahead of the build.\n");
+}
+
+// runs every job in the plan, starting each one as soon as its dependencies
+// have been built.
+void Interpreter::execute_plan(BuildPlan &plan) {
+  plan.graph.send_and_await();
+
+  // whatever was built successfully should be remembered, even if the build
+  // as a whole failed.
+  this->state->commands.save();
+  this->state->discovered_dependencies.save();
+  if (this->state->action_cache)
+    this->state->action_cache->evict();
+  if (this->state->setup.content_hash) {
+    Filesystem::save_hash_database();
+    this->state->digests.save();
   }
 
-  if (!scheduler.was_aborted())
-    this_entry_handle->set_status(CLIEntryStatus::Finished);
+  if (plan.graph.had_errors()) {
+    for (BuildNode const &node : plan.nodes) {
+      for (std::shared_ptr<PipelineJob> const &job : node.jobs) {
+        if (job->had_error()) {
+          node.entry_handle->set_status(CLIEntryStatus::Failed);
+          break;
+        }
+      }
+    }
+    ErrorHandler::trigger_report();
+  }
 }
 
 void Interpreter::build() {
-  // precompute and cache task identifiers
+  // nothing is evaluated before recursive variables have been ruled out.
+  StaticVerify::verify_variables(*this->state->ast,
+                                 this->state->global_programs,
+                                 this->state->task_programs);
+  this->state->commands.load();
+  this->state->discovered_dependencies.load();
+  if (this->state->setup.action_cache && !this->state->setup.dry_run)
+    this->state->action_cache = std::make_unique<ActionCache>(
+        ActionCache::default_directory(), this->state->setup.action_cache_size);
+  if (this->state->setup.content_hash) {
+    Filesystem::load_hash_database();
+    this->state->digests.load();
+  }
+
+  if (this->state->setup.eager_globals)
+    preevaluate_globals();
+
+  // task names that are known in advance are indexed right away, whereas
+  // any other identifier is only evaluated once a lookup may match it.
   for (Task const &task : this->state->ast->tasks) {
     if (!this->state->topmost_task)
-      this->state->topmost_task = task;
-
-    std::unique_ptr<IValue> identifier =
-        evaluate_ast_object(task.identifier, {std::nullopt, std::nullopt});
-    IList<IString> identifiers = identifier->autocast<IList<IString>>();
-
-    std::shared_ptr<Task> task_ptr = std::make_shared<Task>(task);
-    std::vector<IString> keys = identifiers.contents;
-    for (IString const &key_istr : keys) {
-      auto duplicate_it = this->state->cached_tasks.find(key_istr.content);
-      if (duplicate_it != this->state->cached_tasks.end())
-        ErrorHandler::halt(
-            EDuplicateTask{*duplicate_it->second, task, key_istr.content});
-      this->state->cached_tasks[key_istr.content] = task_ptr;
+      this->state->topmost_task = &task;
+
+    std::vector<Instruction> const &code =
+        this->state->identifier_programs[task.id].code;
+    if (code.size() == 1 && code[0].opcode == Opcode::Constant) {
+      index_task(task);
+      continue;
     }
+    std::vector<TaskNamePattern> patterns;
+    std::vector<size_t> visiting;
+    collect_name_patterns(*this->state->ast, task.identifier, patterns,
+                          visiting);
+    for (TaskNamePattern &pattern : patterns)
+      pattern = normalise_name_pattern(pattern);
+    this->state->pending_tasks.push_back({&task, patterns});
   }
 
   // find the task.
   if (this->state->ast->tasks.empty())
     ErrorHandler::halt(ENoTasks{});
-  std::optional<Task> task;
+  Task const *task;
   std::string task_iteration;
   if (this->state->setup.task) {
-    task = find_task(*this->state->setup.task);
-    task_iteration = *this->state->setup.task;
-    if (!task) {
-      ErrorHandler::halt(ETaskNotFound{task_iteration});
+    IndexedTask const *indexed = find_task(*this->state->setup.task);
+    if (!indexed) {
+      ErrorHandler::halt(ETaskNotFound{*this->state->setup.task});
     }
+    task = indexed->task;
+    task_iteration = indexed->iteration;
   } else {
     task =
         this->state->topmost_task; // we've already checked that it's not empty
     std::unique_ptr<IValue> task_iteration_ivalue =
-        evaluate_ast_object(task->identifier, {std::nullopt, std::nullopt});
+        evaluate_program(this->state->identifier_programs[task->id],
+                         {nullptr, std::nullopt});
     if (task_iteration_ivalue->get_type() != IType::IString) {
       ErrorHandler::halt(EAmbiguousTask{*task});
     }
-    task_iteration = dynamic_cast<IString &>(
-                         *evaluate_ast_object(task->identifier,
-                                              {std::nullopt, std::nullopt}))
-                         .to_string();
+    task_iteration =
+        dynamic_cast<IString &>(*task_iteration_ivalue).to_string();
+  }
+
+  FrameGuard frame{FrameKind::EntryBuild, task_iteration, task->reference};
+  // literal cycles are reported before any job is started.
+  StaticVerify::verify_tasks(
+      *this->state->ast, this->state->global_programs,
+      this->state->task_programs, this->state->identifier_programs, *task);
+  BuildPlan plan;
+  // when pipelined, jobs are sent as soon as they have been planned, rather
+  // than once the entire task graph has been evaluated.
+  if (this->state->setup.pipelined)
+    plan.graph.start();
+  try {
+    plan_task(plan, *task, task_iteration, std::nullopt, {});
+  } catch (...) {
+    // jobs that are already running refer to the plan.
+    plan.graph.cancel_and_await();
+    throw;
   }
+  execute_plan(plan);
 
-  FrameGuard frame{EntryBuildFrame(task_iteration, task->reference)};
-  run_task(RunContext{*task, task_iteration, std::nullopt, {}});
+  StatCacheCounters stat_counters = Filesystem::get_stat_cache_counters();
+  CLI::write_verbose("stat cache: " + std::to_string(stat_counters.hits) +
+                     " hits, " + std::to_string(stat_counters.misses) +
+                     " misses.\n");
 }
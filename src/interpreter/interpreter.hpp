@@ -5,53 +5,151 @@
 #include "../errors/types.hpp"
 #include "../parser/types.hpp"
 #include "../cli/cli.hpp"
+#include "../system/action_cache.hpp"
+#include "../system/database.hpp"
+#include "../system/filesystem.hpp"
+#include "../system/paths.hpp"
+#include "../system/pipeline.hpp"
+#include "compiler.hpp"
 #include "types.hpp"
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 struct EvaluationContext {
-  std::optional<Task> task_scope;
+  Task const *task_scope = nullptr; // owned by the ast.
   std::optional<std::string> task_iteration;
-  bool use_globbing = true;
-  bool is_reachable_by(EvaluationContext const) const;
 };
 
-struct ValueInstance {
-  Identifier identifier;
-  EvaluationContext context;
-  std::unique_ptr<IValue> result;
+// identifies a cached variable: values of global fields are cached under
+// GLOBAL_SCOPE, whereas task fields are cached under the id of their task.
+// values that depend on the task iteration are cached per iteration.
+struct EvaluationKey {
+  size_t symbol;
+  size_t scope;
+  std::optional<std::string> iteration;
+  bool operator==(EvaluationKey const &) const = default;
 };
+struct EvaluationKeyHash {
+  size_t operator()(EvaluationKey const &key) const {
+    size_t hash =
+        std::hash<size_t>{}(key.symbol * 0x9e3779b97f4a7c15ull ^ key.scope);
+    if (key.iteration)
+      hash ^= std::hash<std::string>{}(*key.iteration);
+    return hash;
+  }
+};
+// every variable is evaluated at most once - concurrent lookups wait for the
+// thread that evaluates it. a nullptr value signals that the variable cannot
+// be cached under its key, e.g. because it depends on the task iteration.
+struct CachedVariable {
+  std::shared_future<std::shared_ptr<IValue>> value;
+  std::thread::id evaluator;
+};
+// what is known about a global field before evaluating it.
+struct GlobalFieldInfo {
+  bool infallible = true; // evaluates to strings without raising an error.
+  bool globs = false;     // expands a glob, possibly through other fields.
+  std::vector<size_t> references; // global slots it refers to directly.
+};
+// a field visible from a task, along with the symbol it is cached under.
+struct FieldProgram {
+  size_t symbol;
+  Program const *program;
+};
+// summarises every dependency of a task iteration.
+struct DependencyChange {
+  FileTimestamp latest; // FileTimestamp::max() if always out of date.
+  uint64_t digest;      // only computed when content hashing is enabled.
+};
+
+// once normalised, every name a task identifier may evaluate to starts with
+// the prefix and ends with the suffix of at least one of its patterns.
+struct TaskNamePattern {
+  std::string prefix;
+  std::string suffix;
+};
+// a task iteration, along with the name it was declared with.
+struct IndexedTask {
+  Task const *task;
+  std::string iteration;
+};
+// a task whose identifier has not been evaluated yet.
+struct PendingTask {
+  Task const *task;
+  std::vector<TaskNamePattern> patterns;
+};
+
 struct EvaluationState {
   std::unique_ptr<AST> ast;
   Setup setup;
-  std::vector<ValueInstance> cached_variables;
-  std::map<std::string, std::shared_ptr<Task>> cached_tasks;
-  std::optional<Task> topmost_task;
+  // compiled expressions: global slot -> program, task id -> slot -> program,
+  // and task id -> program of the task identifier.
+  std::vector<Program> global_programs;
+  std::vector<std::vector<Program>> task_programs;
+  std::vector<Program> identifier_programs;
+  std::mutex cached_variables_lock;
+  std::unordered_map<EvaluationKey, CachedVariable, EvaluationKeyHash>
+      cached_variables;
+  // thread -> variable it is waiting for, used to detect cyclic waits.
+  std::unordered_map<std::thread::id, EvaluationKey> cached_variable_waits;
+  // task name (as a path) -> task. dynamic task identifiers are only
+  // evaluated once a lookup matches their patterns.
+  std::mutex cached_tasks_lock;
+  std::unordered_map<PathId, IndexedTask> cached_tasks;
+  std::vector<PendingTask> pending_tasks;
+  Task const *topmost_task = nullptr;
+  // task iteration (as a path) -> latest change among its dependencies.
+  std::mutex latest_changes_lock;
+  std::unordered_map<PathId, DependencyChange> latest_changes;
+  // task iteration -> dependency digest when it was last built.
+  BuildDatabase digests{"digests"};
+  // task iteration -> fingerprint of its commands when it was last built.
+  BuildDatabase commands{"commands"};
+  // task iteration -> dependencies discovered through its depfile.
+  BuildDatabase discovered_dependencies{"dependencies"};
+  // only present if the action cache is enabled.
+  std::unique_ptr<ActionCache> action_cache;
 };
 
 struct DependencyStatus {
   bool success;
-  std::optional<size_t> modified;
+  std::optional<FileTimestamp> modified;
 };
 
-struct RunContext {
-  Task task;
+// a task iteration that needs to be rebuilt.
+struct BuildNode {
   std::string task_iteration;
-  std::optional<std::shared_ptr<CLIEntryHandle>> parent_handle;
-  std::vector<std::shared_ptr<Frame>> parent_frame_stack;
+  std::shared_ptr<CLIEntryHandle> entry_handle;
+  std::vector<std::shared_ptr<PipelineJob>> jobs;
+};
+
+// the reachable task graph, evaluated in its entirety before any job is run.
+struct BuildPlan {
+  PipelineGraph graph;
+  std::vector<BuildNode> nodes;
+  // task iteration (as a path) -> graph vertex signalling that the iteration
+  // has been built, or std::nullopt if it is already up to date.
+  std::unordered_map<PathId, std::optional<size_t>> planned;
 };
 
 class Interpreter {
 private:
   std::shared_ptr<EvaluationState> state;
-  std::mutex evaluation_lock;
 
-  std::unique_ptr<IValue> evaluate_ast_object(ASTObject ast_object,
-                                              EvaluationContext context);
-  std::optional<Task> find_task(std::string identifier);
-  std::optional<Field> find_field(std::string identifier,
-                                  std::optional<Task> task);
+  std::unique_ptr<IValue> evaluate_program(Program const &program,
+                                           EvaluationContext context);
+  void index_task(Task const &task);
+  IndexedTask const *find_task(std::string const &identifier);
+  std::optional<FieldProgram>
+  find_field_program(std::string const &identifier, Task const *task);
+  std::unique_ptr<IValue> evaluate_field_program(FieldProgram field,
+                                                 EvaluationContext context);
   std::optional<std::unique_ptr<IValue>>
   evaluate_field_optional(std::string identifier, EvaluationContext context);
   template <typename T>
@@ -66,10 +164,41 @@ private:
                                 EvaluationContext context,
                                 std::optional<T> default_value);
 
-  void run_task(RunContext);
-  size_t compute_latest_dependency_change(IList<IString> dependencies);
-  void solve_dependencies(IList<IString> dependencies,
-                          std::shared_ptr<CLIEntryHandle> parent_iteration, bool parallel);
+  std::optional<size_t>
+  plan_task(BuildPlan &plan, Task const &task, std::string task_iteration,
+            std::optional<std::shared_ptr<CLIEntryHandle>> parent_handle,
+            std::vector<size_t> barrier);
+  std::vector<size_t> plan_dependencies(BuildPlan &plan,
+                                        IList<IString> dependencies,
+                                        std::shared_ptr<CLIEntryHandle> handle,
+                                        bool parallel,
+                                        std::vector<size_t> barrier);
+  void prefetch_dependencies(BuildPlan &plan, IList<IString> dependencies);
+  void execute_plan(BuildPlan &plan);
+  void preevaluate_globals();
+  uint64_t compute_command_fingerprint(Task const &task,
+                                       std::string const &task_iteration);
+  bool has_changed_commands(Task const &task,
+                            std::string const &task_iteration);
+  DependencyChange
+  compute_latest_task_change(std::string task_iteration,
+                             std::optional<IList<IString>> dependencies);
+  std::optional<DependencyChange>
+  find_latest_task_change(std::string task_iteration);
+  void invalidate_latest_task_change(std::string task_iteration);
+  DependencyChange
+  compute_latest_dependency_change(IList<IString> dependencies);
+  void add_discovered_dependencies(std::string task_iteration,
+                                   DependencyChange &change);
+  void ingest_depfile(std::string task_iteration,
+                      std::optional<std::string> depfile);
+  uint64_t compute_action_key(IList<IString> dependencies,
+                              IList<IString> commands,
+                              uint64_t command_fingerprint,
+                              uint64_t dependency_digest,
+                              std::vector<std::string> const &outputs);
+  bool is_up_to_date(std::string task_iteration, DependencyChange change,
+                     uint64_t command_fingerprint);
 
 public:
   Interpreter(AST &ast, Setup &setup);
@@ -1,151 +1,248 @@
 #include "literals.hpp"
 #include <algorithm>
 #include <filesystem>
-#include <iostream>
-
-std::vector<std::string> Globbing::compute_paths(std::string literal) {
-  std::vector<StrComponent> filter = Wildcards::tokenize_components(literal);
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+// a segment of a glob, between two slashes.
+struct GlobSegment {
+  enum class Kind { Literal, Pattern, Recursive } kind;
+  std::string literal;
+  std::optional<WildcardPattern> pattern;
+};
+
+struct GlobWalk {
+  std::vector<GlobSegment> segments;
   std::vector<std::string> paths;
-  for (std::filesystem::directory_entry const &dir_entry :
-       std::filesystem::recursive_directory_iterator(".")) {
-    auto match = Wildcards::match_components(filter, dir_entry.path().string());
-    if (match)
-      paths.push_back(dir_entry.path().string());
+
+  static std::string join(std::string const &directory,
+                          std::string_view name) {
+    std::string path = directory;
+    if (!path.ends_with('/'))
+      path += '/';
+    path += name;
+    return path;
   }
-  return paths;
-}
 
-std::vector<StrComponent> Wildcards::tokenize_components(std::string in) {
-  std::vector<StrComponent> parsed;
-  std::string str_buf;
+  // directory is spelled the way it is reported, which is always relative to
+  // the working directory or absolute.
+  void walk(std::string const &directory, size_t i_segment) {
+    if (i_segment == segments.size()) {
+      paths.push_back(directory);
+      return;
+    }
+    GlobSegment const &segment = segments[i_segment];
+    bool last = i_segment + 1 == segments.size();
+    std::error_code error;
+
+    // literal segments are looked up rather than listed.
+    if (segment.kind == GlobSegment::Kind::Literal) {
+      std::string path = join(directory, segment.literal);
+      if (last ? std::filesystem::exists(path, error)
+               : std::filesystem::is_directory(path, error))
+        walk(path, i_segment + 1);
+      return;
+    }
 
-  for (size_t i = 0; i < in.size(); i++) {
-    if (in[i] == '*') {
-      if (!str_buf.empty()) {
-        parsed.push_back(str_buf);
-        str_buf = "";
+    // `**` matches no directory at all first, and then every directory below,
+    // without following symbolic links that could lead back up.
+    if (segment.kind == GlobSegment::Kind::Recursive)
+      walk(directory, i_segment + 1);
+
+    // unreadable directories cannot contain matches.
+    std::vector<std::string_view> groups;
+    for (std::filesystem::directory_iterator it(directory, error), end;
+         !error && it != end; it.increment(error)) {
+      std::string name = it->path().filename().string();
+      if (segment.kind == GlobSegment::Kind::Recursive) {
+        if (it->is_directory(error) && !it->is_symlink(error))
+          walk(join(directory, name), i_segment);
+        error.clear();
+        continue;
       }
-      // extra variable initialisation here to simply stop gcc from yelling.
-      StrComponent wildcard = Wildcard{};
-      parsed.push_back(wildcard);
-    } else {
-      str_buf += in[i];
+      if (!segment.pattern->match(name, groups))
+        continue;
+      if (last)
+        paths.push_back(join(directory, name));
+      else if (it->is_directory(error))
+        walk(join(directory, name), i_segment + 1);
+      error.clear();
     }
   }
+};
+} // namespace
 
-  if (!str_buf.empty())
-    parsed.push_back(str_buf);
-
-  return parsed;
-}
-
-std::optional<std::vector<std::string>>
-Wildcards::match_components(std::vector<StrComponent> filter, std::string in) {
-  size_t i_str = 0; // index of input string
-  bool matches = true;
-  std::vector<std::string> output;
-
-  // iterate over every component
-  for (size_t i_comp = 0; i_comp < filter.size(); i_comp++) {
-    StrComponent const &component = filter[i_comp];
-    if (std::holds_alternative<std::string>(component)) {
-      // --- match exact characters
-      std::string str_component = std::get<std::string>(component);
-      if (str_component.size() + i_str > in.size()) {
-        // component is greater than input string
-        matches = false;
-        break;
-      } else if (str_component != in.substr(i_str, str_component.size())) {
-        // component simply doesn't match
-        matches = false;
-        break;
-      } else if (i_comp == filter.size() - 1 &&
-                 i_str + str_component.size() < in.size()) {
-        // all components match, but there is input string left
-        matches = false;
-        break;
-      };
-      i_str += str_component.size();
+std::vector<std::string> Globbing::compute_paths(std::string literal) {
+  // the walk starts at the directories in front of the first wildcard. globs
+  // without a prefix are relative to the working directory, and have always
+  // been reported as such.
+  size_t i_slash = literal.rfind('/', literal.find('*'));
+  std::string prefix = i_slash == std::string::npos ? std::string(".")
+                       : i_slash == 0 ? std::string("/")
+                                      : literal.substr(0, i_slash);
+
+  GlobWalk glob;
+  size_t recursive_segments = 0;
+  size_t i_segment = i_slash == std::string::npos ? 0 : i_slash + 1;
+  while (i_segment <= literal.size()) {
+    size_t i_end = literal.find('/', i_segment);
+    if (i_end == std::string::npos)
+      i_end = literal.size();
+    std::string_view segment(literal.data() + i_segment, i_end - i_segment);
+    i_segment = i_end + 1;
+
+    if (segment.empty())
+      continue;
+    if (segment == "**") {
+      // consecutive `**` segments are equivalent to a single one.
+      if (!glob.segments.empty() &&
+          glob.segments.back().kind == GlobSegment::Kind::Recursive)
+        continue;
+      glob.segments.push_back({GlobSegment::Kind::Recursive, "", std::nullopt});
+      recursive_segments++;
+    } else if (segment.find('*') == std::string_view::npos) {
+      glob.segments.push_back(
+          {GlobSegment::Kind::Literal, std::string(segment), std::nullopt});
     } else {
-      // --- match wildcard
-      if (i_comp >= filter.size() - 1) {
-        // final asterisk: don't forget to save it as a reconstruction group.
-        output.push_back(in.substr(i_str, in.size() - i_str));
-        break;
-      }
-      // adjacent wildcards cannot be parsed.
-      if (std::holds_alternative<Wildcard>(filter[i_comp + 1]))
-        throw LiteralsAdjacentWildcards{};
-
-      // index of input string where segment after asterisk starts
-      bool seg_match = false;
-      std::string str_component = std::get<std::string>(filter[i_comp + 1]);
-
-      for (size_t i_seg = 0;
-           i_seg < in.size() - i_str - str_component.size() + 1; i_seg++) {
-        if (in.substr(i_str + i_seg, str_component.size()) == str_component) {
-          if (i_comp == filter.size() - 2 &&
-              i_str + i_seg + str_component.size() < in.size())
-            continue;
-          seg_match = true;
-          output.push_back(in.substr(i_str, i_seg));
-          i_str += i_seg + str_component.size();
-          break;
-        }
-      }
-      if (!seg_match) {
-        matches = false;
-        break;
-      } else {
-        // increment this twice because two components have been matched.
-        i_comp++;
-      }
+      glob.segments.push_back(
+          {GlobSegment::Kind::Pattern, "", WildcardPattern(segment)});
     }
   }
-
-  if (!matches)
-    return std::nullopt;
-  else
-    return output;
+  // a trailing `**` matches every entry below the directory.
+  if (!glob.segments.empty() &&
+      glob.segments.back().kind == GlobSegment::Kind::Recursive)
+    glob.segments.push_back(
+        {GlobSegment::Kind::Pattern, "", WildcardPattern("*")});
+
+  std::error_code error;
+  if (std::filesystem::is_directory(prefix, error))
+    glob.walk(prefix, 0);
+
+  // several `**` segments may match the same path in more than one way.
+  if (recursive_segments > 1) {
+    std::unordered_set<std::string> seen;
+    std::erase_if(glob.paths, [&](std::string const &path) {
+      return !seen.insert(path).second;
+    });
+  }
+  return glob.paths;
 }
 
-std::vector<std::string>
-Wildcards::compute_replace(std::vector<std::string> data, std::string filter,
-                           std::string product) {
-  std::vector<std::string> output;
+std::vector<std::string> Wildcards::split_chunks(std::string_view in) {
+  std::vector<std::string> chunks;
+  size_t i_chunk = 0;
+  for (size_t i_wildcard = in.find('*'); i_wildcard != std::string_view::npos;
+       i_wildcard = in.find('*', i_chunk)) {
+    chunks.emplace_back(in.substr(i_chunk, i_wildcard - i_chunk));
+    i_chunk = i_wildcard + 1;
+  }
+  chunks.emplace_back(in.substr(i_chunk));
+  return chunks;
+}
 
-  std::vector<StrComponent> filter_components = tokenize_components(filter);
-  std::vector<StrComponent> product_components = tokenize_components(product);
+WildcardPattern::WildcardPattern(std::string_view pattern)
+    : chunks(Wildcards::split_chunks(pattern)) {
+  // adjacent wildcards cannot be parsed.
+  for (size_t i_chunk = 1; i_chunk + 1 < chunks.size(); i_chunk++) {
+    if (chunks[i_chunk].empty())
+      throw LiteralsAdjacentWildcards{};
+  }
+}
 
-  size_t wildcards_filter = std::count_if(
-      filter_components.begin(), filter_components.end(),
-      [](StrComponent s) { return std::holds_alternative<Wildcard>(s); });
+bool WildcardPattern::match(std::string_view in,
+                            std::vector<std::string_view> &groups) const {
+  groups.clear();
+  std::string_view prefix = chunks.front();
+  // note: an empty pattern matches every string.
+  if (chunks.size() == 1)
+    return prefix.empty() || in == prefix;
+  if (!in.starts_with(prefix))
+    return false;
+
+  // the chunks between wildcards match their first occurrence. find() is
+  // backed by memchr, which is vectorised by the C library.
+  size_t i_in = prefix.size();
+  for (size_t i_chunk = 1; i_chunk + 1 < chunks.size(); i_chunk++) {
+    std::string_view chunk = chunks[i_chunk];
+    size_t i_found = in.find(chunk, i_in);
+    if (i_found == std::string_view::npos)
+      return false;
+    groups.push_back(in.substr(i_in, i_found - i_in));
+    i_in = i_found + chunk.size();
+  }
 
-  size_t wildcards_product = std::count_if(
-      product_components.begin(), product_components.end(),
-      [](StrComponent s) { return std::holds_alternative<Wildcard>(s); });
+  // whereas the final chunk has to end the input.
+  std::string_view suffix = chunks.back();
+  if (in.size() - i_in < suffix.size() || !in.ends_with(suffix))
+    return false;
+  groups.push_back(in.substr(i_in, in.size() - suffix.size() - i_in));
+  return true;
+}
 
-  if (wildcards_product > wildcards_filter)
+ReplacePattern::ReplacePattern(std::string_view filter,
+                               std::string_view product)
+    : filter(filter), product(Wildcards::split_chunks(product)) {
+  if (this->product.size() - 1 > this->filter.wildcards())
     throw LiteralsChunksLength{};
+  for (std::string const &chunk : this->product)
+    product_length += chunk.size();
+}
 
-  for (const std::string &element : data) {
-    std::optional<std::vector<std::string>> wildcard_groups =
-        match_components(filter_components, element);
-    if (!wildcard_groups) {
-      output.push_back(element);
-      continue;
-    }
-    // weave wildcard with product strcomponents
-    std::string final_str;
-    for (const StrComponent &component : product_components) {
-      if (std::holds_alternative<std::string>(component))
-        final_str += std::get<std::string>(component);
-      else { // wildcard
-        final_str += *wildcard_groups->begin();
-        wildcard_groups->erase(wildcard_groups->begin());
-      }
-    }
-    output.push_back(final_str);
+bool ReplacePattern::apply(std::string_view in,
+                           std::vector<std::string_view> &groups,
+                           std::string &out) const {
+  if (!filter.match(in, groups))
+    return false;
+
+  // weave the groups with the product chunks, which may use fewer groups than
+  // the filter provides.
+  size_t length = product_length;
+  for (size_t i_group = 0; i_group + 1 < product.size(); i_group++)
+    length += groups[i_group].size();
+  out.clear();
+  out.reserve(length);
+  out += product.front();
+  for (size_t i_chunk = 1; i_chunk < product.size(); i_chunk++) {
+    out += groups[i_chunk - 1];
+    out += product[i_chunk];
+  }
+  return true;
+}
+
+namespace {
+struct ReplaceKey {
+  std::string filter;
+  std::string product;
+  bool operator==(ReplaceKey const &) const = default;
+};
+struct ReplaceKeyHash {
+  size_t operator()(ReplaceKey const &key) const {
+    return std::hash<std::string>{}(key.filter) * 31 ^
+           std::hash<std::string>{}(key.product);
   }
-  return output;
+};
+} // namespace
+
+static std::shared_mutex replace_patterns_lock;
+static std::unordered_map<ReplaceKey, std::shared_ptr<ReplacePattern const>,
+                          ReplaceKeyHash>
+    replace_patterns;
+
+std::shared_ptr<ReplacePattern const>
+Wildcards::compile_replace(std::string_view filter, std::string_view product) {
+  ReplaceKey key{std::string(filter), std::string(product)};
+  std::shared_lock<std::shared_mutex> read_guard(replace_patterns_lock);
+  auto pattern_it = replace_patterns.find(key);
+  if (pattern_it != replace_patterns.end())
+    return pattern_it->second;
+  read_guard.unlock();
+
+  // invalid patterns throw here, and are thus never cached.
+  std::shared_ptr<ReplacePattern const> pattern =
+      std::make_shared<ReplacePattern const>(filter, product);
+  std::unique_lock<std::shared_mutex> write_guard(replace_patterns_lock);
+  return replace_patterns.try_emplace(std::move(key), pattern).first->second;
 }
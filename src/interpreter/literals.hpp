@@ -1,32 +1,68 @@
 #ifndef LITERALS_HPP
 #define LITERALS_HPP
 
+#include <memory>
+#include <optional>
 #include <string>
-#include <variant>
+#include <string_view>
 #include <vector>
-#include <optional>
 
+// globs are matched one path segment at a time: `*` never crosses a `/`,
+// whereas a `**` segment matches any number of directories. the walk starts
+// at the literal prefix of the glob, and only descends into directories that
+// can still match.
 class Globbing {
 public:
   static std::vector<std::string> compute_paths(std::string);
 };
 
-// used in matching algorithms.
-struct Wildcard {};
-using StrComponent = std::variant<Wildcard, std::string>;
+// a pattern split at its wildcards once, so that it can be matched against
+// any number of strings without copying them. the chunks are the text before
+// the first, between, and after the last wildcard.
+class WildcardPattern {
+private:
+  std::vector<std::string> chunks;
+
+public:
+  WildcardPattern() = delete;
+  // throws LiteralsAdjacentWildcards, as the groups would be ambiguous.
+  explicit WildcardPattern(std::string_view pattern);
+  size_t wildcards() const { return chunks.size() - 1; }
+  // every wildcard matches the shortest possible text, except for the last
+  // one, which extends up to the final chunk. the text matched by every
+  // wildcard is stored in groups.
+  bool match(std::string_view in, std::vector<std::string_view> &groups) const;
+};
+
+// the filter and product of a replacement, compiled once.
+class ReplacePattern {
+private:
+  WildcardPattern filter;
+  std::vector<std::string> product;
+  size_t product_length = 0; // of the chunks alone.
+
+public:
+  ReplacePattern() = delete;
+  // throws LiteralsAdjacentWildcards and LiteralsChunksLength.
+  ReplacePattern(std::string_view filter, std::string_view product);
+  // writes the product for the input to out, or returns false if the input
+  // does not match the filter. groups is scratch space kept by the caller.
+  bool apply(std::string_view in, std::vector<std::string_view> &groups,
+             std::string &out) const;
+};
 
 class Wildcards {
-  friend class Globbing;
+  friend class WildcardPattern;
+  friend class ReplacePattern;
 
 private:
-  static std::vector<StrComponent> tokenize_components(std::string);
-  // returns wildcard groups
-  static std::optional<std::vector<std::string>> match_components(std::vector<StrComponent>,
-                                                   std::string);
+  static std::vector<std::string> split_chunks(std::string_view);
 
 public:
-  static std::vector<std::string> compute_replace(std::vector<std::string>,
-                                                  std::string, std::string);
+  // patterns are cached for the duration of the build, as the same
+  // replacement is usually evaluated for every task iteration.
+  static std::shared_ptr<ReplacePattern const>
+  compile_replace(std::string_view filter, std::string_view product);
 };
 
 // dummy classes to specify failure.
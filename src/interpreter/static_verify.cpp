@@ -1,47 +1,217 @@
 #include "static_verify.hpp"
+#include "../errors/errors.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <unordered_map>
 
-bool StaticVerify::find_recursive_task(
-    std::vector<std::shared_ptr<Frame>> stack, std::string task) {
-  // it's ok if it appears one time, but more than two times = trouble.
-  size_t count = 0;
-  for (const std::shared_ptr<Frame> &frame_ptr : stack) {
-    std::shared_ptr<EntryBuildFrame> entry_ptr =
-        std::dynamic_pointer_cast<EntryBuildFrame>(frame_ptr);
-    if (entry_ptr) {
-      if (entry_ptr->get_unique_identifier() == task) {
-        count++;
-        continue;
-      } else
-        continue;
+#define OPT_DEPENDS "depends"
+
+thread_local std::vector<PathId> TaskRecursionGuard::in_progress = {};
+
+namespace {
+enum class Visit : uint8_t { Unvisited, InProgress, Done };
+
+// the fields visible from a scope: global slots, followed by the local slots
+// of the task the fields are evaluated on behalf of, if any.
+struct VariableScope {
+  AST const &ast;
+  std::vector<Program> const &global_programs;
+  std::vector<std::vector<Program>> const &task_programs;
+  Task const *task;
+  std::vector<Visit> visits;
+  // the references followed so far, only turned into frames once reported.
+  std::vector<Identifier const *> path;
+
+  // mirrors ProgramEvaluate::load, returning the field an identifier refers
+  // to, or std::nullopt if it does not refer to a field.
+  std::optional<size_t> resolve(Identifier const &identifier) const {
+    if (task) {
+      size_t local_slot = identifier.local_slot;
+      bool is_iterator = identifier.is_iterator;
+      if (identifier.scope != task->id) {
+        local_slot = task->find_slot(identifier.symbol);
+        is_iterator = task->iterator.symbol == identifier.symbol;
+      }
+      if (local_slot != NO_SLOT)
+        return ast.fields.size() + local_slot;
+      if (is_iterator)
+        return std::nullopt;
     }
+    if (identifier.global_slot != NO_SLOT)
+      return identifier.global_slot;
+    return std::nullopt;
+  }
 
-    std::shared_ptr<DependencyBuildFrame> dep_ptr =
-        std::dynamic_pointer_cast<DependencyBuildFrame>(frame_ptr);
-    if (dep_ptr) {
-      if (dep_ptr->get_unique_identifier() == task) {
-        count++;
-        continue;
-      } else
+  Program const &program(size_t field) const {
+    if (field < ast.fields.size())
+      return global_programs[field];
+    return task_programs[task->id][field - ast.fields.size()];
+  }
+
+  void report [[noreturn]] (Identifier const &identifier) {
+    std::deque<FrameGuard> frames;
+    for (Identifier const *reference : path)
+      frames.emplace_back(FrameKind::IdentifierEvaluate, reference->content,
+                          reference->reference);
+    frames.emplace_back(FrameKind::IdentifierEvaluate, identifier.content,
+                        identifier.reference);
+    ErrorHandler::halt(ERecursiveVariable{identifier});
+  }
+
+  void visit(size_t field) {
+    visits[field] = Visit::InProgress;
+    for (Identifier const &identifier : program(field).identifiers) {
+      std::optional<size_t> referenced = resolve(identifier);
+      if (!referenced || visits[*referenced] == Visit::Done)
         continue;
+      if (visits[*referenced] == Visit::InProgress)
+        report(identifier);
+      path.push_back(&identifier);
+      visit(*referenced);
+      path.pop_back();
     }
+    visits[field] = Visit::Done;
+  }
+};
+
+// returns the dependencies of a task if they are a literal.
+std::optional<std::vector<std::string_view>>
+literal_dependencies(AST const &ast,
+                     std::vector<Program> const &global_programs,
+                     std::vector<std::vector<Program>> const &task_programs,
+                     Task const &task) {
+  auto symbol_it = ast.symbols.find(OPT_DEPENDS);
+  if (symbol_it == ast.symbols.end())
+    return std::vector<std::string_view>{};
+  size_t local_slot = task.find_slot(symbol_it->second);
+  size_t global_slot = ast.global_slots[symbol_it->second];
+  Program const *program = nullptr;
+  if (local_slot != NO_SLOT)
+    program = &task_programs[task.id][local_slot];
+  else if (global_slot != NO_SLOT)
+    program = &global_programs[global_slot];
+  else
+    return std::vector<std::string_view>{};
+
+  if (program->code.size() != 1 || program->code[0].opcode != Opcode::Constant)
+    return std::nullopt;
+  IValue &value = *program->constants[program->code[0].operand];
+  std::vector<std::string_view> dependencies;
+  if (value.get_type() == IType::IString) {
+    dependencies.push_back(dynamic_cast<IString &>(value).content);
+  } else if (value.get_type() == IType::IList_IString) {
+    IList<IString> &list = dynamic_cast<IList<IString> &>(value);
+    for (size_t i = 0; i < list.contents.size(); i++)
+      dependencies.push_back(list.contents.view(i));
+  } else {
+    return std::nullopt; // reported once evaluated.
   }
-  return count >= 2;
+  return dependencies;
 }
 
-bool StaticVerify::find_recursive_variable(
-    std::vector<std::shared_ptr<Frame>> stack, std::string variable) {
-  // it's ok if it appears one time, but more than two times = trouble.
-  size_t count = 0;
-  for (const std::shared_ptr<Frame> &frame_ptr : stack) {
-    std::shared_ptr<IdentifierEvaluateFrame> identifier_ptr =
-        std::dynamic_pointer_cast<IdentifierEvaluateFrame>(frame_ptr);
-    if (identifier_ptr) {
-      if (identifier_ptr->get_unique_identifier() == variable) {
-        count++;
+// the tasks whose names and dependencies are literals.
+struct TaskScope {
+  AST const &ast;
+  std::vector<Program> const &global_programs;
+  std::vector<std::vector<Program>> const &task_programs;
+  // task name (as a path) -> task id, along with the name it was declared
+  // with.
+  std::unordered_map<PathId, std::pair<size_t, std::string_view>> names;
+  std::vector<Visit> visits;
+
+  void visit(Task const &task) {
+    visits[task.id] = Visit::InProgress;
+    std::optional<std::vector<std::string_view>> dependencies =
+        literal_dependencies(ast, global_programs, task_programs, task);
+    for (std::string_view dependency : dependencies.value_or(
+             std::vector<std::string_view>{})) {
+      auto name_it = names.find(Paths::intern(dependency));
+      if (name_it == names.end())
         continue;
-      } else
+      auto [id, name] = name_it->second;
+      if (visits[id] == Visit::Done)
         continue;
+      Task const &dependency_task = ast.tasks[id];
+      FrameGuard frame{FrameKind::DependencyBuild, name,
+                       dependency_task.reference};
+      if (visits[id] == Visit::InProgress)
+        ErrorHandler::halt(ERecursiveTask{dependency_task, std::string(name)});
+      visit(dependency_task);
     }
+    visits[task.id] = Visit::Done;
   }
-  return count >= 2;
+};
+} // namespace
+
+void StaticVerify::verify_variables(
+    AST const &ast, std::vector<Program> const &global_programs,
+    std::vector<std::vector<Program>> const &task_programs) {
+  VariableScope global_scope{
+      ast, global_programs, task_programs, nullptr,
+      std::vector<Visit>(ast.fields.size(), Visit::Unvisited), {}};
+  for (size_t slot = 0; slot < ast.fields.size(); slot++) {
+    if (global_scope.visits[slot] == Visit::Unvisited)
+      global_scope.visit(slot);
+  }
+
+  // task fields shadow global ones, so global fields are visited again on
+  // behalf of every task.
+  for (Task const &task : ast.tasks) {
+    VariableScope task_scope{
+        ast, global_programs, task_programs, &task,
+        std::vector<Visit>(ast.fields.size() + task.fields.size(),
+                           Visit::Unvisited),
+        {}};
+    for (size_t slot = 0; slot < task.fields.size(); slot++) {
+      if (task_scope.visits[ast.fields.size() + slot] == Visit::Unvisited)
+        task_scope.visit(ast.fields.size() + slot);
+    }
+  }
+}
+
+void StaticVerify::verify_tasks(
+    AST const &ast, std::vector<Program> const &global_programs,
+    std::vector<std::vector<Program>> const &task_programs,
+    std::vector<Program> const &identifier_programs, Task const &entry) {
+  TaskScope scope{ast, global_programs, task_programs, {},
+                  std::vector<Visit>(ast.tasks.size(), Visit::Unvisited)};
+  for (Task const &task : ast.tasks) {
+    Program const &program = identifier_programs[task.id];
+    if (program.code.size() != 1 ||
+        program.code[0].opcode != Opcode::Constant)
+      continue;
+    IValue &value = *program.constants[program.code[0].operand];
+    if (value.get_type() != IType::IString)
+      continue;
+    std::string_view name = dynamic_cast<IString &>(value).content;
+    scope.names.try_emplace(Paths::intern(name), task.id, name);
+  }
+
+  Program const &entry_program = identifier_programs[entry.id];
+  if (entry_program.code.size() == 1 &&
+      entry_program.code[0].opcode == Opcode::Constant)
+    scope.visit(entry);
+}
+
+TaskRecursionGuard::TaskRecursionGuard(Task const &task,
+                                       std::string const &task_iteration) {
+  PathId id = Paths::intern(task_iteration);
+  if (std::ranges::find(in_progress, id) != in_progress.end())
+    ErrorHandler::halt(ERecursiveTask{task, task_iteration});
+  in_progress.push_back(id);
+}
+
+TaskRecursionGuard::~TaskRecursionGuard() {
+  assert(!in_progress.empty() && "attempt to erase a non-existent task");
+  in_progress.pop_back();
+}
+
+std::vector<PathId> TaskRecursionGuard::export_local_tasks() {
+  return in_progress;
+}
+
+void TaskRecursionGuard::import_local_tasks(std::vector<PathId> local_tasks) {
+  in_progress = std::move(local_tasks);
 }
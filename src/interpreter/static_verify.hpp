@@ -2,11 +2,44 @@
 #define STATIC_VERIFY_HPP
 
 #include "../errors/types.hpp"
+#include "../parser/types.hpp"
+#include "../system/paths.hpp"
+#include "compiler.hpp"
+#include <vector>
 
+// recursion is ruled out before the build starts wherever the config allows
+// it, so that evaluating a field needs no checks at all.
 class StaticVerify {
 public:
-  static bool find_recursive_task(std::vector<std::shared_ptr<Frame>>, std::string);
-  static bool find_recursive_variable(std::vector<std::shared_ptr<Frame>>, std::string);
+  // fields only refer to each other through identifiers, which are resolved
+  // by their scope alone - so every recursive variable is found here.
+  static void
+  verify_variables(AST const &ast, std::vector<Program> const &global_programs,
+                   std::vector<std::vector<Program>> const &task_programs);
+  // follows the dependencies between tasks whose names and dependencies are
+  // literals, starting from the task that is built.
+  static void
+  verify_tasks(AST const &ast, std::vector<Program> const &global_programs,
+               std::vector<std::vector<Program>> const &task_programs,
+               std::vector<Program> const &identifier_programs,
+               Task const &entry);
+};
+
+// task names may be computed, so the remaining recursive dependencies are
+// found while building: every task iteration that is being evaluated on this
+// thread is marked for the lifetime of the guard.
+class TaskRecursionGuard {
+private:
+  static thread_local std::vector<PathId> in_progress;
+
+public:
+  TaskRecursionGuard() = delete;
+  TaskRecursionGuard(Task const &task, std::string const &task_iteration);
+  ~TaskRecursionGuard();
+
+  // jobs evaluating tasks on behalf of another thread continue its set.
+  static std::vector<PathId> export_local_tasks();
+  static void import_local_tasks(std::vector<PathId>);
 };
 
 #endif
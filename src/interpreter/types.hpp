@@ -3,9 +3,13 @@
 
 #include "../lexer/tracking.hpp"
 #include "../lexer/types.hpp"
+#include <initializer_list>
+#include <memory>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
 struct IString;
 struct IBool;
@@ -79,6 +83,166 @@ public:
   bool operator==(IBool const other) const;
 };
 
+// a vector whose elements are shared between copies, and only copied once a
+// copy that shares them is modified. this makes copying evaluated lists O(1).
+template <typename T> class SharedVector {
+private:
+  std::shared_ptr<std::vector<T>> elements; // nullptr if empty.
+
+  std::vector<T> &mutate() {
+    if (!elements)
+      elements = std::make_shared<std::vector<T>>();
+    else if (elements.use_count() > 1)
+      elements = std::make_shared<std::vector<T>>(*elements);
+    return *elements;
+  }
+  std::vector<T> const &view() const {
+    static std::vector<T> const empty;
+    return elements ? *elements : empty;
+  }
+
+public:
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+  SharedVector() = default;
+  SharedVector(std::vector<T> elements)
+      : elements(std::make_shared<std::vector<T>>(std::move(elements))) {}
+  SharedVector(std::initializer_list<T> elements)
+      : elements(std::make_shared<std::vector<T>>(elements)) {}
+
+  const_iterator begin() const { return view().begin(); }
+  const_iterator end() const { return view().end(); }
+  size_t size() const { return view().size(); }
+  bool empty() const { return view().empty(); }
+  T const &operator[](size_t i) const { return view()[i]; }
+  operator std::vector<T> const &() const { return view(); }
+
+  void push_back(T element) { mutate().push_back(std::move(element)); }
+  void append(SharedVector const &other) {
+    if (empty())
+      elements = other.elements; // no need to copy anything.
+    else if (!other.empty()) {
+      std::vector<T> &target = mutate();
+      target.insert(target.end(), other.begin(), other.end());
+    }
+  }
+
+  bool operator==(SharedVector const &other) const {
+    return elements == other.elements || view() == other.view();
+  }
+};
+
+// columnar storage for lists of strings: every element is stored in a single
+// character buffer, and elements sharing a reference (e.g. the results of a
+// glob) share a single copy of it. elements are materialised as IString on
+// access, so that the storage is transparent to the rest of the interpreter.
+class StringColumn {
+private:
+  // elements [first, next run's first) share a reference and mutability.
+  struct Run {
+    size_t first;
+    StreamReference reference;
+    bool immutable;
+  };
+  struct Columns {
+    std::string characters;
+    std::vector<uint32_t> offsets = {0}; // element i is [offsets[i], [i + 1]).
+    std::vector<Run> runs;
+  };
+  std::shared_ptr<Columns> columns; // nullptr if empty, shared between copies.
+
+  Columns &mutate();
+  Run const &find_run(size_t i) const;
+
+public:
+  // elements are returned by value, so the iterator is only an input iterator
+  // to algorithms predating c++20, but random access to the rest.
+  class const_iterator {
+  private:
+    StringColumn const *column;
+    size_t i;
+
+  public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = IString;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = IString;
+
+    const_iterator() : column(nullptr), i(0) {}
+    const_iterator(StringColumn const *column, size_t i)
+        : column(column), i(i) {}
+    IString operator*() const;
+    IString operator[](difference_type n) const;
+
+    const_iterator &operator++() {
+      i++;
+      return *this;
+    }
+    const_iterator operator++(int) { return {column, i++}; }
+    const_iterator &operator--() {
+      i--;
+      return *this;
+    }
+    const_iterator operator--(int) { return {column, i--}; }
+    const_iterator &operator+=(difference_type n) {
+      i += n;
+      return *this;
+    }
+    const_iterator &operator-=(difference_type n) {
+      i -= n;
+      return *this;
+    }
+    const_iterator operator+(difference_type n) const {
+      return {column, i + n};
+    }
+    friend const_iterator operator+(difference_type n,
+                                    const_iterator const &it) {
+      return it + n;
+    }
+    const_iterator operator-(difference_type n) const {
+      return {column, i - n};
+    }
+    difference_type operator-(const_iterator const &other) const {
+      return static_cast<difference_type>(i - other.i);
+    }
+
+    bool operator==(const_iterator const &other) const { return i == other.i; }
+    auto operator<=>(const_iterator const &other) const {
+      return i <=> other.i;
+    }
+  };
+
+  StringColumn() = default;
+  StringColumn(std::vector<IString> const &elements);
+  StringColumn(std::initializer_list<IString> elements);
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, size()}; }
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  IString operator[](size_t i) const;
+  std::string_view view(size_t i) const;
+  StreamReference reference(size_t i) const;
+  operator std::vector<IString>() const;
+
+  void push_back(std::string_view content, StreamReference reference,
+                 bool immutable);
+  void push_back(IString const &element);
+  void append(StringColumn const &other);
+
+  bool operator==(StringColumn const &other) const;
+};
+
+// selects the storage used by IList.
+template <typename T> struct IListStorage {
+  using type = SharedVector<T>;
+};
+template <> struct IListStorage<IString> {
+  using type = StringColumn;
+};
+
 template <typename T> class IList : public IValue {
 private:
   IString cast_to_istring() override;
@@ -90,7 +254,7 @@ public:
   IType get_type() override;
   std::unique_ptr<IValue> clone() override;
 
-  std::vector<T> contents;
+  typename IListStorage<T>::type contents;
 
   IList() = delete;
   IList(std::vector<T>, StreamReference reference, bool);
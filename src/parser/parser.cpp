@@ -30,6 +30,15 @@ bool Field::operator==(Field const &other) const {
   return this->identifier == other.identifier &&
          this->expression == other.expression;
 }
+// tasks only have a handful of fields, so a linear scan is the fastest lookup.
+size_t Task::find_slot(size_t symbol) const {
+  for (size_t slot = 0; slot < fields.size(); slot++) {
+    if (fields[slot].identifier.symbol == symbol)
+      return slot;
+  }
+  return NO_SLOT;
+}
+
 bool Task::operator==(Task const &other) const {
   return this->identifier == other.identifier &&
          this->iterator == other.iterator && this->fields == other.fields;
@@ -59,6 +68,14 @@ bool Parser::check_next(TokenType token_type) {
   return m_next && m_next->type == token_type;
 }
 
+// interns the identifier, so that it can be looked up without comparing
+// strings during evaluation.
+Identifier Parser::make_identifier(std::string content,
+                                   StreamReference reference) {
+  auto symbol_it = m_symbols.try_emplace(content, m_symbols.size()).first;
+  return Identifier{content, reference, symbol_it->second};
+}
+
 // consume a token.
 std::optional<Token> Parser::consume_token() { return consume_token(1); }
 
@@ -87,23 +104,28 @@ std::optional<Token> Parser::consume_if(TokenType token_type) {
 // parses the entire token stream.
 AST Parser::parse_tokens() {
   AST ast;
+  std::unordered_map<std::string, size_t> field_slots;
   while (m_current) {
     std::optional<Field> field = parse_field();
     if (field) {
-      auto duplicate_it = ast.fields.find(field->identifier.content);
-      if (duplicate_it != ast.fields.end())
-        ErrorHandler::halt(EDuplicateIdentifier(duplicate_it->second.identifier,
-                                                field->identifier));
-      ast.fields[field->identifier.content] = *field;
+      auto duplicate_it = field_slots.find(field->identifier.content);
+      if (duplicate_it != field_slots.end())
+        ErrorHandler::halt(
+            EDuplicateIdentifier(ast.fields[duplicate_it->second].identifier,
+                                 field->identifier));
+      field_slots[field->identifier.content] = ast.fields.size();
+      ast.fields.push_back(*field);
       continue;
     }
     std::optional<Task> task = parse_task();
     if (task) {
+      task->id = ast.tasks.size();
       ast.tasks.push_back(*task);
       continue;
     }
     ErrorHandler::halt(EInvalidGrammar{m_current->reference});
   }
+  ast.symbols = m_symbols;
   return AST(ast);
 }
 
@@ -113,8 +135,8 @@ std::optional<Field> Parser::parse_field() {
     return std::nullopt;
 
   Token identifier_token = *consume_token();
-  Identifier identifier = Identifier{
-      std::get<CTX_STR>(*identifier_token.context), identifier_token.reference};
+  Identifier identifier = make_identifier(
+      std::get<CTX_STR>(*identifier_token.context), identifier_token.reference);
   StreamReference ref_initial = identifier_token.reference;
   consume_token(); // consume the `=`.
 
@@ -143,27 +165,29 @@ std::optional<Task> Parser::parse_task() {
   // technically not fully representative of task, but we also don't want
   // to render the entire task in the code preview if something goes wrong
   StreamReference reference = std::visit(ASTVisitReference{}, *identifier);
-  Identifier iterator = Identifier{"__task__", reference};
+  Identifier iterator = make_identifier("__task__", reference);
   // check if an explicit iterator name has been declared.
   std::optional<Token> explicit_iterate = consume_if(TokenType::IterateAs);
   if (explicit_iterate) {
     std::optional<Token> iterator_token = consume_if(TokenType::Identifier);
     if (!iterator_token)
       ErrorHandler::halt(ENoIterator{explicit_iterate->reference});
-    iterator = Identifier{std::get<CTX_STR>(*iterator_token->context),
-                          iterator_token->reference};
+    iterator = make_identifier(std::get<CTX_STR>(*iterator_token->context),
+                               iterator_token->reference);
   }
   if (!consume_if(TokenType::TaskOpen))
     ErrorHandler::halt(ENoTaskOpen{reference});
 
   std::optional<Field> field;
-  std::map<std::string, Field> fields;
+  std::vector<Field> fields;
+  std::unordered_map<std::string, size_t> field_slots;
   while ((field = parse_field())) {
-    auto duplicate_it = fields.find(field->identifier.content);
-    if (duplicate_it != fields.end())
-      ErrorHandler::halt(EDuplicateIdentifier(duplicate_it->second.identifier,
-                                              field->identifier));
-    fields[field->identifier.content] = *field;
+    auto duplicate_it = field_slots.find(field->identifier.content);
+    if (duplicate_it != field_slots.end())
+      ErrorHandler::halt(EDuplicateIdentifier(
+          fields[duplicate_it->second].identifier, field->identifier));
+    field_slots[field->identifier.content] = fields.size();
+    fields.push_back(*field);
   }
 
   if (!consume_if(TokenType::TaskClose))
@@ -249,7 +273,8 @@ std::optional<ASTObject> Parser::parse_primary() {
   if ((token = consume_if(TokenType::Literal)))
     return Literal{std::get<CTX_STR>(*token->context), token->reference};
   else if ((token = consume_if(TokenType::Identifier)))
-    return Identifier{std::get<CTX_STR>(*token->context), token->reference};
+    return make_identifier(std::get<CTX_STR>(*token->context),
+                           token->reference);
   else if ((token = consume_if(TokenType::True)))
     return Boolean{true, token->reference};
   else if ((token = consume_if(TokenType::False)))
@@ -267,8 +292,8 @@ std::optional<ASTObject> Parser::parse_primary() {
                                    internal_token.reference});
       else if (internal_token.type == TokenType::Identifier)
         contents.push_back(
-            Identifier{std::get<CTX_STR>(*internal_token.context),
-                       internal_token.reference});
+            make_identifier(std::get<CTX_STR>(*internal_token.context),
+                            internal_token.reference));
       else {
         ErrorHandler::halt(EInvalidEscapedExpression{internal_token.reference});
       }
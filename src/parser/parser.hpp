@@ -4,6 +4,8 @@
 #include "../lexer/types.hpp"
 #include "types.hpp"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 // visitor that simply returns the origin of an AST object.
@@ -34,12 +36,14 @@ private:
   size_t m_index;
   std::optional<Token> m_current;
   std::optional<Token> m_next;
+  std::unordered_map<std::string, size_t> m_symbols;
 
   std::optional<Token> consume_token();
   std::optional<Token> consume_token(int n);
   std::optional<Token> consume_if(TokenType token_type);
   bool check_current(TokenType token_type);
   bool check_next(TokenType token_type);
+  Identifier make_identifier(std::string content, StreamReference reference);
 
   std::optional<ASTObject> parse_ast_object();
   std::optional<ASTObject> parse_list();
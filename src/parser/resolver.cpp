@@ -0,0 +1,46 @@
+#include "resolver.hpp"
+
+Resolver::Resolver(AST &ast) : m_ast(ast) {}
+
+// populates the global slot table, and resolves every expression in the AST.
+void Resolver::resolve() {
+  m_ast.global_slots.assign(m_ast.symbols.size(), NO_SLOT);
+  for (size_t slot = 0; slot < m_ast.fields.size(); slot++)
+    m_ast.global_slots[m_ast.fields[slot].identifier.symbol] = slot;
+
+  for (Field &field : m_ast.fields)
+    resolve_object(field.expression, nullptr);
+  for (Task &task : m_ast.tasks) {
+    // the task identifier is evaluated before any iteration exists.
+    resolve_object(task.identifier, nullptr);
+    for (Field &field : task.fields)
+      resolve_object(field.expression, &task);
+  }
+}
+
+// identifiers are resolved in the same order as they are looked up during
+// evaluation: task fields, the task iterator, and finally global fields.
+void Resolver::resolve_object(ASTObject &ast_object, Task const *task) {
+  if (Identifier *identifier = std::get_if<Identifier>(&ast_object)) {
+    if (task) {
+      identifier->scope = task->id;
+      for (size_t slot = 0; slot < task->fields.size(); slot++) {
+        if (task->fields[slot].identifier.symbol == identifier->symbol)
+          identifier->local_slot = slot;
+      }
+      identifier->is_iterator = task->iterator.symbol == identifier->symbol;
+    }
+    identifier->global_slot = m_ast.global_slots[identifier->symbol];
+  } else if (FormattedLiteral *formatted_literal =
+                 std::get_if<FormattedLiteral>(&ast_object)) {
+    for (ASTObject &content : formatted_literal->contents)
+      resolve_object(content, task);
+  } else if (List *list = std::get_if<List>(&ast_object)) {
+    for (ASTObject &content : list->contents)
+      resolve_object(content, task);
+  } else if (Replace *replace = std::get_if<Replace>(&ast_object)) {
+    resolve_object(*replace->input, task);
+    resolve_object(*replace->filter, task);
+    resolve_object(*replace->product, task);
+  }
+}
@@ -0,0 +1,19 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include "types.hpp"
+
+// binds every identifier in the AST to the slots of the fields it may refer
+// to, so that the interpreter does not need to look up fields by name.
+class Resolver {
+private:
+  AST &m_ast;
+
+  void resolve_object(ASTObject &ast_object, Task const *task);
+
+public:
+  Resolver(AST &ast);
+  void resolve();
+};
+
+#endif
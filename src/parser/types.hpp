@@ -2,8 +2,11 @@
 #define PARSER_TYPES_HPP
 
 #include "../lexer/types.hpp"
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 struct Identifier;
 struct Literal;
@@ -15,9 +18,21 @@ using ASTObject =
     std::variant<Identifier, Literal, FormattedLiteral, List, Boolean, Replace>;
 
 // Logic: Expressions
+// marks the absence of a slot, as well as the global (task-less) scope.
+#define NO_SLOT SIZE_MAX
+#define GLOBAL_SCOPE SIZE_MAX
+
 struct Identifier {
   std::string content;
   StreamReference reference;
+  // identifiers with the same content share a symbol.
+  size_t symbol = 0;
+  // bound by the resolver: the task whose scope the identifier appears in, and
+  // the slots of the task and global fields it refers to.
+  size_t scope = GLOBAL_SCOPE;
+  size_t local_slot = NO_SLOT;
+  size_t global_slot = NO_SLOT;
+  bool is_iterator = false;
   bool operator==(Identifier const &other) const;
   // Identifier() = delete;
 };
@@ -65,14 +80,22 @@ struct Field {
 struct Task {
   ASTObject identifier;
   Identifier iterator;
-  std::map<std::string, Field> fields;
-  // std::vector<Field> fields;
+  // slot -> field, in order of declaration.
+  std::vector<Field> fields;
   StreamReference reference;
+  // index into AST::tasks.
+  size_t id = 0;
+  // returns the slot of the field with the given symbol, or NO_SLOT.
+  size_t find_slot(size_t symbol) const;
   bool operator==(Task const &other) const;
   // Task() = delete;
 };
 struct AST {
-  std::map<std::string, Field> fields;
+  // slot -> field, in order of declaration.
+  std::vector<Field> fields;
+  // identifier -> symbol, and symbol -> global slot (or NO_SLOT).
+  std::unordered_map<std::string, size_t> symbols;
+  std::vector<size_t> global_slots;
   // tasks need to be precomputed before being stored in a tree.
   std::vector<Task> tasks;
   std::optional<Task> topmost_task;
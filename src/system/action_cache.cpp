@@ -0,0 +1,244 @@
+#include "action_cache.hpp"
+#include "database.hpp"
+#include "filesystem.hpp"
+#include "hashing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <unistd.h>
+
+// older executions are dropped from a manifest once this limit is reached.
+#define MANIFEST_CAPACITY 16
+
+namespace fs = std::filesystem;
+
+// an execution is stored as the discovered inputs along with their hashes,
+// followed by the blob of every output.
+struct ManifestEntry {
+  std::vector<std::string> inputs;
+  std::vector<uint64_t> input_hashes;
+  std::vector<std::string> blobs;
+};
+
+static std::optional<std::string> read_file(std::string const &path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open())
+    return std::nullopt;
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  return buffer.str();
+}
+
+// several builds may share the cache, so files are always replaced atomically.
+static std::string get_temporary_path(std::string const &path) {
+  static std::atomic_size_t counter = 0;
+  return std::format("{}.tmp.{}.{}", path, getpid(), counter++);
+}
+
+static void write_file(std::string const &path, std::string const &contents) {
+  std::string temporary_path = get_temporary_path(path);
+  std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open())
+    return;
+  stream.write(contents.data(), contents.size());
+  stream.close();
+  std::error_code error;
+  if (stream.fail() || (fs::rename(temporary_path, path, error), error))
+    fs::remove(temporary_path, error);
+}
+
+static std::vector<ManifestEntry> parse_manifest(std::string const &contents) {
+  std::vector<ManifestEntry> entries;
+  for (std::string const &packed : BuildDatabase::unpack_strings(contents)) {
+    std::vector<std::string> fields = BuildDatabase::unpack_strings(packed);
+    if (fields.size() != 3)
+      continue;
+    ManifestEntry entry{BuildDatabase::unpack_strings(fields[0]),
+                        BuildDatabase::unpack(fields[1]),
+                        BuildDatabase::unpack_strings(fields[2])};
+    if (entry.inputs.size() == entry.input_hashes.size())
+      entries.push_back(entry);
+  }
+  return entries;
+}
+
+static std::string serialize_manifest(std::vector<ManifestEntry> const &entries) {
+  std::vector<std::string> packed;
+  for (ManifestEntry const &entry : entries)
+    packed.push_back(BuildDatabase::pack_strings(
+        {BuildDatabase::pack_strings(entry.inputs),
+         BuildDatabase::pack(entry.input_hashes),
+         BuildDatabase::pack_strings(entry.blobs)}));
+  return BuildDatabase::pack_strings(packed);
+}
+
+// marks a file as recently used.
+static void touch(std::string const &path) {
+  std::error_code error;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+}
+
+ActionCache::ActionCache(std::string directory, uint64_t capacity)
+    : directory(directory), capacity(capacity) {
+  std::error_code error;
+  fs::create_directories(this->directory + "/actions", error);
+  fs::create_directories(this->directory + "/blobs", error);
+}
+
+std::string ActionCache::default_directory() {
+  if (char const *directory = std::getenv("QVICKBUILD_CACHE_DIR"))
+    return directory;
+  if (char const *cache_home = std::getenv("XDG_CACHE_HOME"))
+    return std::string(cache_home) + "/qvickbuild";
+  if (char const *home = std::getenv("HOME"))
+    return std::string(home) + "/.cache/qvickbuild";
+  return std::string(DATABASE_DIRECTORY) + "/cache";
+}
+
+std::string ActionCache::get_manifest_path(uint64_t key) {
+  return std::format("{}/actions/{:016x}", this->directory, key);
+}
+
+std::string ActionCache::get_blob_path(std::string const &blob) {
+  return std::format("{}/blobs/{}", this->directory, blob);
+}
+
+bool ActionCache::restore(uint64_t key,
+                          std::vector<std::string> const &outputs) {
+  std::string manifest_path = get_manifest_path(key);
+  std::optional<std::string> manifest = read_file(manifest_path);
+  if (!manifest)
+    return false;
+
+  for (ManifestEntry const &entry : parse_manifest(*manifest)) {
+    if (entry.blobs.size() != outputs.size())
+      continue;
+    bool matches = true;
+    for (size_t i = 0; matches && i < entry.inputs.size(); i++) {
+      std::optional<uint64_t> hash = Filesystem::get_file_hash(entry.inputs[i]);
+      matches = hash && *hash == entry.input_hashes[i];
+    }
+    if (!matches)
+      continue;
+
+    // outputs are hardlinked where possible, as they are never modified in
+    // place: blobs are read-only, and restored outputs are removed before
+    // rebuilding, whether or not they are still linked.
+    bool restored = true;
+    for (size_t i = 0; restored && i < outputs.size(); i++) {
+      std::string blob_path = get_blob_path(entry.blobs[i]);
+      std::error_code error;
+      fs::remove(outputs[i], error);
+      fs::create_hard_link(blob_path, outputs[i], error);
+      if (error) {
+        error.clear();
+        fs::copy_file(blob_path, outputs[i], error);
+      }
+      restored = !error;
+      // outputs must appear newer than their inputs.
+      touch(outputs[i]);
+      Filesystem::invalidate_file_timestamp(outputs[i]);
+    }
+    if (!restored)
+      continue;
+    touch(manifest_path);
+    return true;
+  }
+  return false;
+}
+
+void ActionCache::store(uint64_t key, std::vector<std::string> const &inputs,
+                        std::vector<std::string> const &outputs) {
+  ManifestEntry new_entry;
+  for (std::string const &input : inputs) {
+    std::optional<uint64_t> hash = Filesystem::get_file_hash(input);
+    if (!hash)
+      return; // the execution cannot be reproduced.
+    new_entry.inputs.push_back(input);
+    new_entry.input_hashes.push_back(*hash);
+  }
+
+  for (std::string const &output : outputs) {
+    std::optional<uint64_t> hash = Hashing::hash_file(output);
+    std::error_code error;
+    uint64_t size = fs::file_size(output, error);
+    if (!hash || error)
+      return;
+    std::string blob = std::format("{:016x}-{:x}", *hash, size);
+    std::string blob_path = get_blob_path(blob);
+    if (fs::exists(blob_path, error)) {
+      touch(blob_path);
+    } else {
+      std::string temporary_path = get_temporary_path(blob_path);
+      fs::copy_file(output, temporary_path, error);
+      fs::permissions(temporary_path,
+                      fs::perms::owner_write | fs::perms::group_write |
+                          fs::perms::others_write,
+                      fs::perm_options::remove, error);
+      fs::rename(temporary_path, blob_path, error);
+      if (error) {
+        fs::remove(temporary_path, error);
+        return;
+      }
+    }
+    new_entry.blobs.push_back(blob);
+  }
+
+  // the newest execution is tried first.
+  std::unique_lock<std::mutex> guard(this->cache_lock);
+  std::string manifest_path = get_manifest_path(key);
+  std::vector<ManifestEntry> entries = {new_entry};
+  if (std::optional<std::string> manifest = read_file(manifest_path)) {
+    for (ManifestEntry const &entry : parse_manifest(*manifest)) {
+      if (entries.size() >= MANIFEST_CAPACITY)
+        break;
+      if (entry.inputs != new_entry.inputs ||
+          entry.input_hashes != new_entry.input_hashes)
+        entries.push_back(entry);
+    }
+  }
+  write_file(manifest_path, serialize_manifest(entries));
+}
+
+void ActionCache::evict() {
+  std::unique_lock<std::mutex> guard(this->cache_lock);
+  struct CacheFile {
+    fs::path path;
+    fs::file_time_type used;
+    uint64_t size;
+  };
+  std::vector<CacheFile> files;
+  uint64_t total_size = 0;
+  std::error_code error;
+  for (std::string subdirectory : {"/actions", "/blobs"}) {
+    for (fs::directory_entry const &entry :
+         fs::directory_iterator(this->directory + subdirectory, error)) {
+      std::error_code entry_error;
+      uint64_t size = entry.file_size(entry_error);
+      fs::file_time_type used = entry.last_write_time(entry_error);
+      if (entry_error)
+        continue;
+      files.push_back({entry.path(), used, size});
+      total_size += size;
+    }
+  }
+  if (total_size <= this->capacity)
+    return;
+
+  // manifests referring to evicted blobs are simply treated as misses.
+  std::sort(files.begin(), files.end(),
+            [](CacheFile const &a, CacheFile const &b) {
+              return a.used < b.used;
+            });
+  for (CacheFile const &file : files) {
+    if (total_size <= this->capacity)
+      break;
+    if (fs::remove(file.path, error))
+      total_size -= file.size;
+  }
+}
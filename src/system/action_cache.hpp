@@ -0,0 +1,40 @@
+#ifndef ACTION_CACHE_HPP
+#define ACTION_CACHE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// a content-addressed store of task outputs, shared between every project on
+// the machine. actions are identified by a key covering their commands and
+// declared inputs; as inputs discovered through depfiles are only known after
+// an action has run, every key maps to a manifest of candidate executions
+// along with the discovered inputs they were produced from.
+class ActionCache {
+private:
+  std::string directory;
+  uint64_t capacity; // in bytes.
+  std::mutex cache_lock;
+
+  std::string get_manifest_path(uint64_t key);
+  std::string get_blob_path(std::string const &blob);
+
+public:
+  ActionCache() = delete;
+  ActionCache(std::string directory, uint64_t capacity);
+
+  // $QVICKBUILD_CACHE_DIR, falling back to the XDG cache directory.
+  static std::string default_directory();
+
+  // materialises the outputs of a previous execution whose discovered inputs
+  // are unchanged. returns false if there is none.
+  bool restore(uint64_t key, std::vector<std::string> const &outputs);
+  // records the outputs of an execution, along with its discovered inputs.
+  void store(uint64_t key, std::vector<std::string> const &inputs,
+             std::vector<std::string> const &outputs);
+  // removes the least recently used entries until the cache fits its capacity.
+  void evict();
+};
+
+#endif
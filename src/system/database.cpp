@@ -0,0 +1,131 @@
+#include "database.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// bump the version whenever the format of an existing database changes.
+#define DATABASE_MAGIC "qvickbuild-db-1\n"
+
+BuildDatabase::BuildDatabase(std::string name) {
+  this->path = std::string(DATABASE_DIRECTORY) + "/" + name;
+  this->modified = false;
+}
+
+static bool read_chunk(std::ifstream &stream, std::string &out) {
+  uint32_t size;
+  if (!stream.read(reinterpret_cast<char *>(&size), sizeof(size)))
+    return false;
+  out.resize(size);
+  return (bool)stream.read(out.data(), size);
+}
+
+static void write_chunk(std::ofstream &stream, std::string const &chunk) {
+  uint32_t size = chunk.size();
+  stream.write(reinterpret_cast<char const *>(&size), sizeof(size));
+  stream.write(chunk.data(), size);
+}
+
+void BuildDatabase::load() {
+  std::unique_lock<std::mutex> guard(this->database_lock);
+  this->entries.clear();
+  std::ifstream stream(this->path, std::ios::binary);
+  if (!stream.is_open())
+    return;
+
+  std::string magic(strlen(DATABASE_MAGIC), '\0');
+  if (!stream.read(magic.data(), magic.size()) || magic != DATABASE_MAGIC)
+    return;
+
+  std::string key, value;
+  while (read_chunk(stream, key)) {
+    if (!read_chunk(stream, value)) {
+      // truncated database: discard everything rather than trusting it.
+      this->entries.clear();
+      return;
+    }
+    this->entries[key] = value;
+  }
+}
+
+void BuildDatabase::save() {
+  std::unique_lock<std::mutex> guard(this->database_lock);
+  if (!this->modified)
+    return;
+
+  // write to a temporary file first so that an interrupted build can never
+  // leave a partially written database behind.
+  std::error_code error;
+  std::filesystem::create_directories(DATABASE_DIRECTORY, error);
+  std::string temporary_path = this->path + ".tmp";
+  std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open())
+    return;
+  stream.write(DATABASE_MAGIC, strlen(DATABASE_MAGIC));
+  for (auto const &[key, value] : this->entries) {
+    write_chunk(stream, key);
+    write_chunk(stream, value);
+  }
+  stream.close();
+  if (stream.fail())
+    return;
+  std::filesystem::rename(temporary_path, this->path, error);
+  this->modified = false;
+}
+
+std::optional<std::string> BuildDatabase::get(std::string const &key) {
+  std::unique_lock<std::mutex> guard(this->database_lock);
+  auto entry_it = this->entries.find(key);
+  if (entry_it == this->entries.end())
+    return std::nullopt;
+  return entry_it->second;
+}
+
+void BuildDatabase::put(std::string const &key, std::string value) {
+  std::unique_lock<std::mutex> guard(this->database_lock);
+  this->entries[key] = std::move(value);
+  this->modified = true;
+}
+
+void BuildDatabase::erase(std::string const &key) {
+  std::unique_lock<std::mutex> guard(this->database_lock);
+  if (this->entries.erase(key))
+    this->modified = true;
+}
+
+std::string BuildDatabase::pack(std::vector<uint64_t> const &values) {
+  std::string packed(values.size() * sizeof(uint64_t), '\0');
+  memcpy(packed.data(), values.data(), packed.size());
+  return packed;
+}
+
+std::vector<uint64_t> BuildDatabase::unpack(std::string const &packed) {
+  std::vector<uint64_t> values(packed.size() / sizeof(uint64_t));
+  memcpy(values.data(), packed.data(), values.size() * sizeof(uint64_t));
+  return values;
+}
+
+std::string BuildDatabase::pack_strings(std::vector<std::string> const &values) {
+  std::string packed;
+  for (std::string const &value : values) {
+    uint32_t size = value.size();
+    packed.append(reinterpret_cast<char const *>(&size), sizeof(size));
+    packed.append(value);
+  }
+  return packed;
+}
+
+std::vector<std::string>
+BuildDatabase::unpack_strings(std::string const &packed) {
+  std::vector<std::string> values;
+  size_t offset = 0;
+  while (offset + sizeof(uint32_t) <= packed.size()) {
+    uint32_t size;
+    memcpy(&size, packed.data() + offset, sizeof(size));
+    offset += sizeof(size);
+    if (offset + size > packed.size())
+      break;
+    values.push_back(packed.substr(offset, size));
+    offset += size;
+  }
+  return values;
+}
@@ -0,0 +1,43 @@
+#ifndef DATABASE_HPP
+#define DATABASE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// persistent state is stored relative to the project directory.
+#define DATABASE_DIRECTORY "./.qvickbuild"
+
+// a persistent key-value store. the database is kept in memory for the
+// duration of the build and written back to disk afterwards.
+class BuildDatabase {
+private:
+  std::string path;
+  std::mutex database_lock;
+  std::unordered_map<std::string, std::string> entries;
+  bool modified;
+
+public:
+  BuildDatabase() = delete;
+  explicit BuildDatabase(std::string name);
+
+  // a missing or corrupt database is treated as empty.
+  void load();
+  void save();
+
+  std::optional<std::string> get(std::string const &key);
+  void put(std::string const &key, std::string value);
+  void erase(std::string const &key);
+
+  // helpers for storing fixed-width integers.
+  static std::string pack(std::vector<uint64_t> const &);
+  static std::vector<uint64_t> unpack(std::string const &);
+  // helpers for storing lists of paths.
+  static std::string pack_strings(std::vector<std::string> const &);
+  static std::vector<std::string> unpack_strings(std::string const &);
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "depfile.hpp"
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+static bool is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\0';
+}
+
+// splits a logical line of the form `targets: prerequisites` into its
+// prerequisites, resolving escaped spaces and `$$`.
+static void parse_rule(std::string const &line,
+                       std::vector<std::string> &prerequisites) {
+  std::string word;
+  bool after_targets = false;
+  auto flush = [&]() {
+    if (after_targets && !word.empty())
+      prerequisites.push_back(word);
+    word.clear();
+  };
+
+  for (size_t i = 0; i < line.size(); i++) {
+    char c = line[i];
+    char next = i + 1 < line.size() ? line[i + 1] : '\0';
+    if (c == '\\' && (next == ' ' || next == '#' || next == '\\')) {
+      word += next;
+      i++;
+    } else if (c == '$' && next == '$') {
+      word += '$';
+      i++;
+    } else if (c == ':' && !after_targets && is_whitespace(next)) {
+      // everything up to here named the targets of the rule.
+      word.clear();
+      after_targets = true;
+    } else if (is_whitespace(c)) {
+      flush();
+    } else if (c == '#' && word.empty()) {
+      // comments run until the end of the line.
+      break;
+    } else {
+      word += c;
+    }
+  }
+  flush();
+}
+
+std::optional<std::vector<std::string>>
+Depfile::parse(std::string const &path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open())
+    return std::nullopt;
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  std::string contents = buffer.str();
+
+  // join continued lines, so that every rule sits on a single line.
+  std::vector<std::string> prerequisites;
+  std::string line;
+  for (size_t i = 0; i < contents.size(); i++) {
+    if (contents[i] == '\\' && i + 1 < contents.size() &&
+        contents[i + 1] == '\n') {
+      line += ' ';
+      i++;
+    } else if (contents[i] == '\\' && i + 2 < contents.size() &&
+               contents[i + 1] == '\r' && contents[i + 2] == '\n') {
+      line += ' ';
+      i += 2;
+    } else if (contents[i] == '\n') {
+      parse_rule(line, prerequisites);
+      line.clear();
+    } else {
+      line += contents[i];
+    }
+  }
+  parse_rule(line, prerequisites);
+
+  // `-MP` adds rules for every header, which would list them twice.
+  std::vector<std::string> unique_prerequisites;
+  std::unordered_set<std::string> seen;
+  for (std::string const &prerequisite : prerequisites) {
+    if (seen.insert(prerequisite).second)
+      unique_prerequisites.push_back(prerequisite);
+  }
+  return unique_prerequisites;
+}
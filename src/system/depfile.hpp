@@ -0,0 +1,15 @@
+#ifndef DEPFILE_HPP
+#define DEPFILE_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// reads make-style dependency files, as generated by e.g. `gcc -MD`.
+namespace Depfile {
+// returns every prerequisite listed in the file, regardless of the target it
+// belongs to, or std::nullopt if the file cannot be read.
+std::optional<std::vector<std::string>> parse(std::string const &path);
+} // namespace Depfile
+
+#endif
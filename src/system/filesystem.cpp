@@ -1,21 +1,143 @@
 #include "filesystem.hpp"
+#include "database.hpp"
+#include "hashing.hpp"
+#include "paths.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
 #include <sys/stat.h>
+#include <unordered_map>
 
 // this might incorrectly modify struct name.
 #ifdef WIN32
 #define stat _stat
+#ifndef S_ISREG
+#define S_ISREG(mode) (((mode) & _S_IFMT) == _S_IFREG)
+#endif
 #endif
 
-// account for darwin naming conventions.
-#ifdef __APPLE__
-#define ST_CTIME st_ctimespec.tv_sec
+// account for darwin naming conventions, and for windows only recording
+// modification times in seconds.
+#if defined(WIN32)
+#define ST_MTIME_SEC(t_stat) (t_stat).st_mtime
+#define ST_MTIME_NSEC(t_stat) 0
+#elif defined(__APPLE__)
+#define ST_MTIME_SEC(t_stat) (t_stat).st_mtimespec.tv_sec
+#define ST_MTIME_NSEC(t_stat) (t_stat).st_mtimespec.tv_nsec
 #else
-#define ST_CTIME st_ctime
+#define ST_MTIME_SEC(t_stat) (t_stat).st_mtim.tv_sec
+#define ST_MTIME_NSEC(t_stat) (t_stat).st_mtim.tv_nsec
 #endif
 
-std::optional<size_t> Filesystem::get_file_timestamp(std::string path) {
+FileTimestamp FileTimestamp::min() { return FileTimestamp{0, 0}; }
+FileTimestamp FileTimestamp::max() {
+  return FileTimestamp{std::numeric_limits<int64_t>::max(),
+                       std::numeric_limits<int64_t>::max()};
+}
+
+// path -> status, or std::nullopt if the file does not exist. paths are
+// interned, so that every spelling of a path shares a single entry.
+static std::shared_mutex stat_cache_lock;
+static std::unordered_map<PathId, std::optional<FileStatus>> stat_cache;
+static std::atomic_size_t stat_cache_hits = 0;
+static std::atomic_size_t stat_cache_misses = 0;
+
+std::optional<FileStatus> Filesystem::get_file_status(std::string path) {
+  return Filesystem::get_file_status(Paths::intern(path));
+}
+
+std::optional<FileStatus> Filesystem::get_file_status(PathId path) {
+  std::shared_lock<std::shared_mutex> read_guard(stat_cache_lock);
+  auto cache_it = stat_cache.find(path);
+  if (cache_it != stat_cache.end()) {
+    stat_cache_hits++;
+    return cache_it->second;
+  }
+  read_guard.unlock();
+
+  stat_cache_misses++;
   struct stat t_stat;
-  if (0 > stat(path.c_str(), &t_stat))
+  std::optional<FileStatus> status = std::nullopt;
+  if (0 <= stat(Paths::resolve(path).c_str(), &t_stat))
+    status = FileStatus{
+        FileTimestamp{static_cast<int64_t>(ST_MTIME_SEC(t_stat)),
+                      static_cast<int64_t>(ST_MTIME_NSEC(t_stat))},
+        static_cast<uint64_t>(t_stat.st_size),
+        static_cast<uint64_t>(t_stat.st_ino),
+        S_ISREG(t_stat.st_mode),
+    };
+
+  std::unique_lock<std::shared_mutex> write_guard(stat_cache_lock);
+  stat_cache[path] = status;
+  return status;
+}
+
+// the modification time is used rather than the change time, as the latter is
+// also updated by e.g. chmod and chown.
+std::optional<FileTimestamp> Filesystem::get_file_timestamp(std::string path) {
+  return Filesystem::get_file_timestamp(Paths::intern(path));
+}
+
+std::optional<FileTimestamp> Filesystem::get_file_timestamp(PathId path) {
+  std::optional<FileStatus> status = Filesystem::get_file_status(path);
+  if (!status)
+    return std::nullopt;
+  return status->modified;
+}
+
+void Filesystem::invalidate_file_timestamp(std::string path) {
+  PathId id = Paths::intern(path);
+  std::unique_lock<std::shared_mutex> guard(stat_cache_lock);
+  stat_cache.erase(id);
+}
+
+StatCacheCounters Filesystem::get_stat_cache_counters() {
+  return StatCacheCounters{stat_cache_hits, stat_cache_misses};
+}
+
+// path -> size, modification time, inode, and content hash.
+static BuildDatabase hash_database("hashes");
+
+void Filesystem::load_hash_database() { hash_database.load(); }
+void Filesystem::save_hash_database() { hash_database.save(); }
+
+// hashes are recorded under the normalised path.
+std::optional<uint64_t> Filesystem::get_file_hash(std::string path_str) {
+  PathId id = Paths::intern(path_str);
+  std::string const &path = Paths::resolve(id);
+  std::optional<FileStatus> status = Filesystem::get_file_status(id);
+  if (!status)
+    return std::nullopt;
+  std::vector<uint64_t> fingerprint = {
+      status->size,
+      static_cast<uint64_t>(status->modified.seconds),
+      static_cast<uint64_t>(status->modified.nanoseconds),
+      status->inode,
+  };
+
+  // directories and other special files can't be read, so their metadata is
+  // the best approximation of their contents.
+  if (!status->regular) {
+    uint64_t hash = 0;
+    for (uint64_t value : fingerprint)
+      hash = Hashing::combine(hash, value);
+    return hash;
+  }
+
+  std::optional<std::string> record = hash_database.get(path);
+  if (record) {
+    std::vector<uint64_t> values = BuildDatabase::unpack(*record);
+    if (values.size() == fingerprint.size() + 1 &&
+        std::equal(fingerprint.begin(), fingerprint.end(), values.begin()))
+      return values.back();
+  }
+
+  std::optional<uint64_t> hash = Hashing::hash_file(path);
+  if (!hash)
     return std::nullopt;
-  return t_stat.ST_CTIME;
+  fingerprint.push_back(*hash);
+  hash_database.put(path, BuildDatabase::pack(fingerprint));
+  return hash;
 }
@@ -1,12 +1,50 @@
 #ifndef FILESYSTEM_HPP
 #define FILESYSTEM_HPP
 
+#include "paths.hpp"
+#include <compare>
+#include <cstdint>
 #include <optional>
 #include <stddef.h>
 #include <string>
 
+// modification time of a file, with nanosecond precision.
+struct FileTimestamp {
+  int64_t seconds;
+  int64_t nanoseconds;
+  auto operator<=>(FileTimestamp const &) const = default;
+  // sentinels that are older/newer than any file.
+  static FileTimestamp min();
+  static FileTimestamp max();
+};
+
+struct FileStatus {
+  FileTimestamp modified;
+  uint64_t size;
+  uint64_t inode;
+  bool regular;
+};
+
+struct StatCacheCounters {
+  size_t hits;
+  size_t misses;
+};
+
 namespace Filesystem {
-std::optional<size_t> get_file_timestamp(std::string);
+// timestamps are cached for the entire build, and must be invalidated
+// explicitly once a file has been modified.
+std::optional<FileStatus> get_file_status(std::string);
+std::optional<FileStatus> get_file_status(PathId);
+std::optional<FileTimestamp> get_file_timestamp(std::string);
+std::optional<FileTimestamp> get_file_timestamp(PathId);
+void invalidate_file_timestamp(std::string);
+StatCacheCounters get_stat_cache_counters();
+
+// content hashes are persisted across builds, and are only recomputed once
+// the size, modification time or inode of a file changes.
+void load_hash_database();
+void save_hash_database();
+std::optional<uint64_t> get_file_hash(std::string);
 }
 
 #endif
@@ -0,0 +1,151 @@
+#include "hashing.hpp"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+// files are hashed in chunks so that large outputs don't need to be kept in
+// memory. must be a multiple of the 32 byte stripe size.
+#define FILE_CHUNK_SIZE (256 * 1024)
+
+static inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(unsigned char const *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t read32(unsigned char const *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * PRIME64_2;
+  acc = rotl(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static inline uint64_t merge_round(uint64_t acc, uint64_t value) {
+  acc ^= round(0, value);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+// streaming state, the four lanes are independent and thus vectorise well.
+struct HashState {
+  uint64_t lanes[4];
+  uint64_t seed;
+  uint64_t total_length;
+  unsigned char buffer[32];
+  size_t buffered;
+
+  explicit HashState(uint64_t seed) : seed(seed), total_length(0), buffered(0) {
+    lanes[0] = seed + PRIME64_1 + PRIME64_2;
+    lanes[1] = seed + PRIME64_2;
+    lanes[2] = seed;
+    lanes[3] = seed - PRIME64_1;
+  }
+
+  void consume_stripe(unsigned char const *p) {
+    for (int i = 0; i < 4; i++)
+      lanes[i] = round(lanes[i], read64(p + i * 8));
+  }
+
+  void update(unsigned char const *p, size_t length) {
+    total_length += length;
+    if (buffered + length < 32) {
+      memcpy(buffer + buffered, p, length);
+      buffered += length;
+      return;
+    }
+    if (buffered > 0) {
+      size_t fill = 32 - buffered;
+      memcpy(buffer + buffered, p, fill);
+      consume_stripe(buffer);
+      p += fill;
+      length -= fill;
+      buffered = 0;
+    }
+    for (; length >= 32; p += 32, length -= 32)
+      consume_stripe(p);
+    memcpy(buffer, p, length);
+    buffered = length;
+  }
+
+  uint64_t digest() const {
+    uint64_t h64;
+    if (total_length >= 32) {
+      h64 = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) +
+            rotl(lanes[3], 18);
+      for (int i = 0; i < 4; i++)
+        h64 = merge_round(h64, lanes[i]);
+    } else {
+      h64 = seed + PRIME64_5;
+    }
+    h64 += total_length;
+
+    unsigned char const *p = buffer;
+    size_t remaining = buffered;
+    for (; remaining >= 8; p += 8, remaining -= 8) {
+      h64 ^= round(0, read64(p));
+      h64 = rotl(h64, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (remaining >= 4) {
+      h64 ^= static_cast<uint64_t>(read32(p)) * PRIME64_1;
+      h64 = rotl(h64, 23) * PRIME64_2 + PRIME64_3;
+      p += 4;
+      remaining -= 4;
+    }
+    for (; remaining > 0; p++, remaining--) {
+      h64 ^= (*p) * PRIME64_5;
+      h64 = rotl(h64, 11) * PRIME64_1;
+    }
+
+    // avalanche.
+    h64 ^= h64 >> 33;
+    h64 *= PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= PRIME64_3;
+    h64 ^= h64 >> 32;
+    return h64;
+  }
+};
+
+uint64_t Hashing::hash_bytes(void const *data, size_t length, uint64_t seed) {
+  HashState state(seed);
+  state.update(static_cast<unsigned char const *>(data), length);
+  return state.digest();
+}
+
+uint64_t Hashing::hash_string(std::string const &str, uint64_t seed) {
+  return Hashing::hash_bytes(str.data(), str.size(), seed);
+}
+
+uint64_t Hashing::combine(uint64_t a, uint64_t b) {
+  return Hashing::hash_bytes(&b, sizeof(b), a);
+}
+
+std::optional<uint64_t> Hashing::hash_file(std::string const &path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open())
+    return std::nullopt;
+  HashState state(0);
+  std::vector<char> chunk(FILE_CHUNK_SIZE);
+  while (stream) {
+    stream.read(chunk.data(), chunk.size());
+    state.update(reinterpret_cast<unsigned char const *>(chunk.data()),
+                 stream.gcount());
+  }
+  if (stream.bad())
+    return std::nullopt;
+  return state.digest();
+}
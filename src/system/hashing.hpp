@@ -0,0 +1,18 @@
+#ifndef HASHING_HPP
+#define HASHING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// non-cryptographic hashing (xxh64) for detecting changes in file contents.
+namespace Hashing {
+uint64_t hash_bytes(void const *, size_t, uint64_t seed = 0);
+uint64_t hash_string(std::string const &, uint64_t seed = 0);
+uint64_t combine(uint64_t, uint64_t);
+// returns std::nullopt if the file cannot be read.
+std::optional<uint64_t> hash_file(std::string const &);
+} // namespace Hashing
+
+#endif
@@ -0,0 +1,62 @@
+#include "paths.hpp"
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+std::string Paths::normalise(std::string_view path) {
+  std::string normalised;
+  normalised.reserve(path.size());
+  if (path.starts_with('/'))
+    normalised += '/';
+
+  size_t i_component = 0;
+  while (i_component <= path.size()) {
+    size_t i_end = path.find('/', i_component);
+    if (i_end == std::string_view::npos)
+      i_end = path.size();
+    std::string_view component =
+        path.substr(i_component, i_end - i_component);
+    if (!component.empty() && component != ".") {
+      if (!normalised.empty() && normalised.back() != '/')
+        normalised += '/';
+      normalised += component;
+    }
+    i_component = i_end + 1;
+  }
+
+  if (normalised.empty())
+    return path.empty() ? "" : ".";
+  return normalised;
+}
+
+// id -> path. a deque keeps references to interned paths stable.
+static std::shared_mutex paths_lock;
+static std::deque<std::string> paths;
+static std::unordered_map<std::string_view, PathId> path_ids;
+
+PathId Paths::intern(std::string_view path) {
+  std::string normalised = Paths::normalise(path);
+  std::shared_lock<std::shared_mutex> read_guard(paths_lock);
+  auto id_it = path_ids.find(normalised);
+  if (id_it != path_ids.end())
+    return id_it->second;
+  read_guard.unlock();
+
+  std::unique_lock<std::shared_mutex> write_guard(paths_lock);
+  // another thread may have interned the path in the meantime.
+  id_it = path_ids.find(normalised);
+  if (id_it != path_ids.end())
+    return id_it->second;
+  assert(paths.size() < UINT32_MAX && "path table exceeds the maximum size");
+  PathId id = paths.size();
+  paths.push_back(std::move(normalised));
+  path_ids[paths.back()] = id;
+  return id;
+}
+
+std::string const &Paths::resolve(PathId id) {
+  std::shared_lock<std::shared_mutex> guard(paths_lock);
+  return paths[id];
+}
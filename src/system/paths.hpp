@@ -0,0 +1,21 @@
+#ifndef PATHS_HPP
+#define PATHS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// compact handle for a normalised path, valid for the duration of the build.
+using PathId = uint32_t;
+
+// paths are interned once, so that different spellings of the same path, e.g.
+// "./src/x.cpp" and "src/x.cpp", are looked up by the same integer.
+namespace Paths {
+// lexically removes empty and "." components. ".." components are kept, as
+// they may traverse symbolic links.
+std::string normalise(std::string_view);
+PathId intern(std::string_view);
+std::string const &resolve(PathId);
+} // namespace Paths
+
+#endif
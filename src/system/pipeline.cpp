@@ -27,10 +27,17 @@ void Pipeline::stop_async() {
 }
 
 void Pipeline::abort_queued() {
+  // jobs are notified outside of the lock, as a graph may push its remaining
+  // jobs to the queue while being notified.
+  std::unique_lock<std::mutex> guard(Pipeline::queue_lock);
+  std::vector<std::shared_ptr<PipelineJob>> aborted_jobs;
   for (std::shared_ptr<PipelineJob> &job : Pipeline::job_queue) {
-    job->mark_aborted();
-    job->notifier.release(); // allow waiting client to return.
+    if (!job->aborted.exchange(true))
+      aborted_jobs.push_back(job);
   }
+  guard.unlock();
+  for (std::shared_ptr<PipelineJob> &job : aborted_jobs)
+    job->notify_completion(); // allow waiting client to return.
 }
 
 void Pipeline::push_to_queue(std::shared_ptr<PipelineJob> job_ptr) {
@@ -69,7 +76,13 @@ void Pipeline::pool_loop() {
 
 void Pipeline::job_compute(std::shared_ptr<PipelineJob> job_ptr) {
   job_ptr->compute();
-  job_ptr->notifier.release();
+  job_ptr->notify_completion();
+}
+
+void PipelineJob::notify_completion() {
+  this->notifier.release();
+  if (this->graph)
+    this->graph->complete_vertex(this->graph_vertex);
 }
 
 void PipelineJob::await_completion() { this->notifier.acquire(); }
@@ -164,3 +177,115 @@ void PipelineScheduler<PipelineSchedulingMethod::Unbound>::send_and_await() {
     assert(false && "invalid pipeline scheduling topography");
   }
 }
+
+size_t PipelineGraph::add_job(std::shared_ptr<PipelineJob> job_ptr,
+                              std::vector<size_t> const &dependencies) {
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  size_t vertex = this->vertices.size();
+  job_ptr->graph = this;
+  job_ptr->graph_vertex = vertex;
+  this->vertices.push_back(Vertex{job_ptr, {}, 0, false, false});
+  for (size_t dependency : dependencies) {
+    assert(dependency < vertex && "attempt to depend on an unknown job");
+    // a running graph may have completed the dependency already.
+    if (this->vertices[dependency].completed)
+      continue;
+    this->vertices[dependency].dependents.push_back(vertex);
+    this->vertices[vertex].pending++;
+  }
+
+  // jobs added to a running graph are sent as soon as they are ready.
+  bool ready = this->running && this->vertices[vertex].pending == 0 &&
+               is_healthy();
+  if (ready) {
+    this->vertices[vertex].dispatched = true;
+    this->in_flight++;
+  }
+  guard.unlock();
+
+  if (ready)
+    Pipeline::push_to_queue(job_ptr);
+  return vertex;
+}
+
+bool PipelineGraph::is_healthy() const {
+  return !this->error && !this->aborted && !this->cancelled;
+}
+
+void PipelineGraph::complete_vertex(size_t vertex) {
+  std::vector<std::shared_ptr<PipelineJob>> ready;
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  Vertex &completed_vertex = this->vertices[vertex];
+  completed_vertex.completed = true;
+  this->completed++;
+  this->in_flight--;
+  if (completed_vertex.job->had_error())
+    this->error = true;
+  if (completed_vertex.job->was_aborted())
+    this->aborted = true;
+  // dependents are only released if the build is still healthy.
+  if (is_healthy()) {
+    for (size_t dependent : completed_vertex.dependents) {
+      if (--this->vertices[dependent].pending == 0) {
+        this->vertices[dependent].dispatched = true;
+        ready.push_back(this->vertices[dependent].job);
+        this->in_flight++;
+      }
+    }
+  }
+  // notify while the lock is held, as the graph may go out of scope as soon
+  // as the awaiting thread has returned.
+  this->graph_condition.notify_all();
+  guard.unlock();
+
+  // the pipeline is only accessed outside of the graph lock.
+  for (std::shared_ptr<PipelineJob> const &job_ptr : ready)
+    Pipeline::push_to_queue(job_ptr);
+}
+
+bool PipelineGraph::had_errors() {
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  return this->error;
+}
+
+bool PipelineGraph::was_aborted() {
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  return this->aborted;
+}
+
+void PipelineGraph::start() {
+  std::vector<std::shared_ptr<PipelineJob>> ready;
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  this->running = true;
+  if (is_healthy()) {
+    for (Vertex &vertex : this->vertices) {
+      if (!vertex.dispatched && vertex.pending == 0) {
+        vertex.dispatched = true;
+        ready.push_back(vertex.job);
+        this->in_flight++;
+      }
+    }
+  }
+  guard.unlock();
+
+  for (std::shared_ptr<PipelineJob> const &job_ptr : ready)
+    Pipeline::push_to_queue(job_ptr);
+}
+
+void PipelineGraph::send_and_await() {
+  start();
+
+  // wait until every job has completed, or until the last job in flight has
+  // returned after an error.
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  this->graph_condition.wait(guard, [this] {
+    return this->in_flight == 0 &&
+           (this->completed == this->vertices.size() || !is_healthy());
+  });
+}
+
+void PipelineGraph::cancel_and_await() {
+  std::unique_lock<std::mutex> guard(this->graph_lock);
+  this->cancelled = true;
+  this->graph_condition.wait(guard, [this] { return this->in_flight == 0; });
+}
@@ -2,14 +2,18 @@
 #define PIPELINE_HPP
 
 #include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <semaphore>
 #include <thread>
 #include <vector>
 
+class PipelineGraph;
+
 class PipelineJob {
   friend class Pipeline;
+  friend class PipelineGraph;
   template <typename M> friend class PipelineScheduler;
 
 private:
@@ -17,8 +21,16 @@ private:
   std::atomic_bool error;
   std::atomic_bool aborted;
 
+  // set if the job is part of a graph, which needs to know when it completes.
+  PipelineGraph *graph;
+  size_t graph_vertex;
+
+  void notify_completion();
+
 public:
-  PipelineJob() : notifier{0}, error(false), aborted(false) {};
+  PipelineJob()
+      : notifier{0}, error(false), aborted(false), graph(nullptr),
+        graph_vertex(0) {};
 
   virtual void compute() noexcept = 0;
   void await_completion();
@@ -88,4 +100,44 @@ public:
   PipelineScheduler(PipelineSchedulingTopography);
 };
 
+// schedules a dependency graph of jobs on the managed pipeline. a job is sent
+// as soon as every job it depends on has completed, and no further jobs are
+// sent once a job has reported an error. jobs may still be added once the
+// graph has been started, in which case they are sent as soon as they are
+// ready.
+class PipelineGraph {
+  friend class PipelineJob;
+
+private:
+  struct Vertex {
+    std::shared_ptr<PipelineJob> job;
+    std::vector<size_t> dependents;
+    size_t pending; // dependencies that have not yet completed.
+    bool dispatched;
+    bool completed;
+  };
+
+  std::mutex graph_lock;
+  std::condition_variable graph_condition;
+  std::vector<Vertex> vertices;
+  size_t in_flight = 0;
+  size_t completed = 0;
+  bool running = false;
+  bool error = false;
+  bool aborted = false;
+  bool cancelled = false;
+
+  bool is_healthy() const;
+  void complete_vertex(size_t);
+
+public:
+  size_t add_job(std::shared_ptr<PipelineJob>, std::vector<size_t> const &);
+  bool had_errors();
+  bool was_aborted();
+  void start();
+  void send_and_await();
+  // stops sending jobs and waits for the jobs in flight.
+  void cancel_and_await();
+};
+
 #endif
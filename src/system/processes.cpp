@@ -3,17 +3,19 @@
 #include "../errors/errors.hpp"
 #include "../kal/processes.hpp"
 #include "../lexer/tracking.hpp"
+#include "filesystem.hpp"
 #include <format>
 #include <sys/stat.h>
 
 PipelineJobs::ExecuteJob::ExecuteJob(
     std::string cmdline, StreamReference reference,
-    std::shared_ptr<CLIEntryHandle> entry_handle,
-    ExecutionOptions options) {
+    std::shared_ptr<CLIEntryHandle> entry_handle, ExecutionOptions options,
+    std::string output) {
   this->cmdline = cmdline;
   this->reference = reference;
   this->entry_handle = entry_handle;
   this->options = options;
+  this->output = output;
 }
 
 void PipelineJobs::ExecuteJob::compute_fallback() noexcept {
@@ -46,6 +48,9 @@ void PipelineJobs::ExecuteJob::compute_fallback() noexcept {
     ErrorHandler::soft_report(EProcessInternal{cmdline, reference});
     this->report_error();
   }
+
+  // the output has (most likely) been modified.
+  Filesystem::invalidate_file_timestamp(this->output);
 }
 
 void PipelineJobs::ExecuteJob::compute() noexcept {
@@ -87,4 +92,7 @@ void PipelineJobs::ExecuteJob::compute() noexcept {
     ErrorHandler::soft_report(EProcessInternal{cmdline, reference});
     this->report_error();
   }
+
+  // the output has (most likely) been modified.
+  Filesystem::invalidate_file_timestamp(this->output);
 }
@@ -18,12 +18,14 @@ private:
   StreamReference reference;
   std::shared_ptr<CLIEntryHandle> entry_handle;
   ExecutionOptions options;
+  std::string output; // file that the command may modify.
   void compute_fallback() noexcept;
 
 public:
   ExecuteJob() = delete;
   explicit ExecuteJob(std::string, StreamReference,
-                      std::shared_ptr<CLIEntryHandle>, ExecutionOptions);
+                      std::shared_ptr<CLIEntryHandle>, ExecutionOptions,
+                      std::string);
   void compute() noexcept;
 };
 } // namespace PipelineJobs